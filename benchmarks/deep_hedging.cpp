@@ -0,0 +1,113 @@
+// Deep hedging benchmarks: batched network passes, training minibatches,
+// path simulation under both samplers and single-state hedge latency
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "../common/random.h"
+#include "../research_projects/deep_hedging.h"
+#include "../research_projects/deep_hedging_agent.h"
+#include "../research_projects/hedge_inference.h"
+#include "../research_projects/neural_network.h"
+
+namespace {
+
+void BM_NetworkForward(benchmark::State& state) {
+    const size_t batch = state.range(0);
+    NeuralNetwork network({5, 32, 32, 1});
+    NetworkWorkspace ws(network, batch);
+    std::vector<double> inputs(batch * hedgeFeatureCount);
+    Philox4x32(5).fillNormal(inputs.data(), inputs.size());
+    for (auto _ : state) benchmark::DoNotOptimize(network.forward(inputs.data(), batch, ws));
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_NetworkForward)->Arg(1)->Arg(256)->Arg(4096);
+
+void BM_NetworkForwardBackward(benchmark::State& state) {
+    const size_t batch = state.range(0);
+    NeuralNetwork network({5, 32, 32, 1});
+    NetworkWorkspace ws(network, batch);
+    std::vector<double> inputs(batch * hedgeFeatureCount), outputGrad(batch);
+    std::vector<double> gradient(network.parameterCount(), 0.0);
+    Philox4x32(5).fillNormal(inputs.data(), inputs.size());
+    for (auto _ : state) {
+        const double* out = network.forward(inputs.data(), batch, ws);
+        std::copy(out, out + batch, outputGrad.begin());
+        network.backward(outputGrad.data(), ws, gradient.data());
+    }
+    benchmark::DoNotOptimize(gradient.data());
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_NetworkForwardBackward)->Arg(256)->Arg(4096);
+
+// One Adam step on a 2048-path minibatch of 50 steps; items are episodes
+void BM_TrainingMinibatch(benchmark::State& state) {
+    NeuralNetwork network({5, 32, 32, 1});
+    TrainingSettings settings;
+    settings.batchPaths = 2048;
+    HedgingTrainer trainer(network, HedgingMarket(), settings);
+    for (auto _ : state) benchmark::DoNotOptimize(trainer.step());
+    state.SetItemsProcessed(state.iterations() * settings.batchPaths);
+}
+BENCHMARK(BM_TrainingMinibatch)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Terminal P&L of 16384 paths; argument 0 for Philox, 1 for Sobol + bridge
+void BM_HedgingSimulation(benchmark::State& state) {
+    const size_t paths = 16384;
+    NeuralNetwork network({5, 32, 32, 1});
+    const PathSampling sampling = state.range(0) ? PathSampling::SobolBridge : PathSampling::PseudoRandom;
+    HedgingSimulator simulator(network, HedgingMarket(), sampling);
+    std::vector<double> pnl(paths);
+    for (auto _ : state) {
+        simulator.simulate(pnl.data(), paths, 1);
+        benchmark::DoNotOptimize(pnl.data());
+    }
+    state.SetItemsProcessed(state.iterations() * paths);
+}
+BENCHMARK(BM_HedgingSimulation)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Hedge for one market state: allocating double network, then frozen copies
+std::vector<double> hedgeStates() {
+    Philox4x32 rng(17);
+    std::vector<double> states(4096 * hedgeFeatureCount);
+    for (size_t i = 0; i < states.size(); i += hedgeFeatureCount) {
+        states[i] = 100.0 * (0.8 + 0.4 * rng.uniform());
+        states[i + 1] = rng.uniform();
+        states[i + 2] = 0.16 + 0.08 * rng.uniform();
+        states[i + 3] = 2.0 * rng.uniform() - 1.0;
+        states[i + 4] = 10.0 * rng.normal();
+    }
+    return states;
+}
+
+void BM_HedgeRatioDouble(benchmark::State& state) {
+    DeepHedgingAgent agent;
+    const std::vector<double> states = hedgeStates();
+    size_t i = 0;
+    for (auto _ : state) {
+        const double* s = &states[i];
+        benchmark::DoNotOptimize(agent.getHedgeRatio(s[0], s[1], s[2], s[3], s[4]));
+        i = (i + hedgeFeatureCount) % states.size();
+    }
+}
+BENCHMARK(BM_HedgeRatioDouble);
+
+template <InferencePrecision P>
+void BM_HedgeRatioFrozen(benchmark::State& state) {
+    const auto frozen = DeepHedgingAgent().freeze<P>();
+    const std::vector<double> states = hedgeStates();
+    size_t i = 0;
+    for (auto _ : state) {
+        const double* s = &states[i];
+        benchmark::DoNotOptimize(hedgeRatio(frozen, s[0], s[1], s[2], s[3], s[4]));
+        i = (i + hedgeFeatureCount) % states.size();
+    }
+}
+BENCHMARK_TEMPLATE(BM_HedgeRatioFrozen, InferencePrecision::Float32);
+BENCHMARK_TEMPLATE(BM_HedgeRatioFrozen, InferencePrecision::Int8);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,120 @@
+// Option pricer benchmarks: closed-form Greeks per object and in SIMD
+// batches, implied vols, the American PDE engine and Monte Carlo
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "../common/random.h"
+#include "../common/thread_pool.h"
+#include "../projects/option-pricer/american_pde.h"
+#include "../projects/option-pricer/black_scholes_batch.h"
+#include "../projects/option-pricer/implied_vol.h"
+#include "../projects/option-pricer/monte_carlo.h"
+#include "../projects/option-pricer/option.h"
+#include "../projects/option-pricer/vanilla_option.h"
+
+namespace {
+
+EuropeanCallBatch randomCalls(size_t n, uint64_t seed) {
+    Philox4x32 rng(seed);
+    EuropeanCallBatch batch;
+    batch.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        batch.add(80.0 + 40.0 * rng.uniform(), 50.0 + 100.0 * rng.uniform(), 0.05 + 1.95 * rng.uniform(), 0.05,
+                  0.1 + 0.5 * rng.uniform());
+    }
+    return batch;
+}
+
+void BM_VirtualOptionGreeks(benchmark::State& state) {
+    const size_t n = state.range(0);
+    EuropeanCallBatch calls = randomCalls(n, 42);
+    std::vector<std::unique_ptr<Option>> book;
+    for (size_t i = 0; i < n; ++i) {
+        book.push_back(std::make_unique<EuropeanCall>(calls.spot[i], calls.strike[i], calls.expiry[i], calls.rate[i],
+                                                      calls.volatility[i]));
+    }
+    for (auto _ : state) {
+        for (const auto& option : book) benchmark::DoNotOptimize(option->greeks());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_VirtualOptionGreeks)->Arg(100000);
+
+void BM_BatchGreeks(benchmark::State& state) {
+    const size_t n = state.range(0);
+    EuropeanCallBatch calls = randomCalls(n, 42);
+    BatchGreeks greeks;
+    for (auto _ : state) {
+        priceBatch(calls, greeks);
+        benchmark::DoNotOptimize(greeks.price.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_BatchGreeks)->Arg(100000);
+
+void BM_VanillaBookGreeks(benchmark::State& state) {
+    using StaticCall = VanillaOption<Call, European>;
+    const size_t n = state.range(0);
+    EuropeanCallBatch calls = randomCalls(n, 11);
+    VanillaBook<StaticCall> book;
+    for (size_t i = 0; i < n; ++i) {
+        book.add(StaticCall(calls.spot[i], calls.strike[i], calls.expiry[i], calls.rate[i], calls.volatility[i]));
+    }
+    GreeksColumns columns;
+    columns.resize(n);
+    for (auto _ : state) {
+        book.greeks(columns);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_VanillaBookGreeks)->Arg(100000);
+
+void BM_ImpliedVol(benchmark::State& state) {
+    const size_t n = state.range(0);
+    EuropeanCallBatch calls = randomCalls(n, 7);
+    BatchGreeks greeks;
+    priceBatch(calls, greeks);
+    CallQuoteBatch quotes;
+    for (size_t i = 0; i < n; ++i) {
+        quotes.add(greeks.price[i], calls.spot[i], calls.strike[i], calls.expiry[i], calls.rate[i]);
+    }
+    ImpliedVolResult result;
+    for (auto _ : state) {
+        solveImpliedVol(quotes, result);
+        benchmark::DoNotOptimize(result.volatility.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ImpliedVol)->Arg(100000);
+
+// One American put per iteration on an n x n Crank-Nicolson grid
+void BM_AmericanPutPde(benchmark::State& state) {
+    PdeGrid grid;
+    grid.spaceSteps = grid.timeSteps = static_cast<int>(state.range(0));
+    CrankNicolsonSolver solver(grid);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(solver.price<Put, American>(100.0, 100.0, 1.0, 0.05, 0.2));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AmericanPutPde)->Arg(50)->Arg(100)->Arg(200)->Arg(400);
+
+// Asian call over 252 monitoring dates, paths per second by thread count
+void BM_MonteCarloAsian(benchmark::State& state) {
+    ThreadPool pool(state.range(0));
+    MonteCarloSettings settings;
+    settings.paths = 65536;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(priceMonteCarlo(AsianCallPayoff{100}, 100, 1.0, 0.05, 0.2, settings, pool));
+    }
+    state.SetItemsProcessed(state.iterations() * settings.paths);
+}
+BENCHMARK(BM_MonteCarloAsian)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+// Portfolio benchmarks on one-factor universes: blocked covariance risk,
+// incremental weight updates, scenario tail risk and the optimizer
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../common/random.h"
+#include "../projects/portfolio-manager/covariance.h"
+#include "../projects/portfolio-manager/optimizer.h"
+#include "../projects/portfolio-manager/tail_risk.h"
+
+namespace {
+
+// Sigma_ij = beta_i beta_j f^2 + delta_ij s_i^2
+PackedSymmetricMatrix oneFactorCovariance(size_t n, uint64_t seed) {
+    Philox4x32 rng(seed);
+    std::vector<double> b(n), s(n);
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = 0.5 + rng.uniform();
+        s[i] = 0.1 + 0.3 * rng.uniform();
+    }
+    PackedSymmetricMatrix cov(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) cov.set(i, j, b[i] * b[j] * 0.04 + (i == j ? s[i] * s[i] : 0.0));
+    }
+    return cov;
+}
+
+void BM_QuadraticForm(benchmark::State& state) {
+    const size_t n = state.range(0);
+    PackedSymmetricMatrix cov = oneFactorCovariance(n, 1);
+    std::vector<double> w(n, 1.0 / n);
+    for (auto _ : state) benchmark::DoNotOptimize(cov.quadraticForm(w.data()));
+    state.SetBytesProcessed(state.iterations() * 4 * n * (n + 1));
+}
+BENCHMARK(BM_QuadraticForm)->Arg(1000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+void BM_IncrementalWeightUpdate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    PackedSymmetricMatrix cov = oneFactorCovariance(n, 1);
+    IncrementalRisk risk(cov, std::vector<double>(n, 1.0 / n));
+    size_t update = 0;
+    for (auto _ : state) {
+        risk.updateWeight(update * 7919 % n, (update % 3 + 1.0) / n);
+        ++update;
+    }
+    benchmark::DoNotOptimize(risk.variance());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IncrementalWeightUpdate)->Arg(5000);
+
+void BM_GenerateScenarios(benchmark::State& state) {
+    const size_t assets = state.range(0), scenarios = state.range(1);
+    CholeskyFactor factor(oneFactorCovariance(assets, 5));
+    std::vector<double> mean(assets, 0.0);
+    for (auto _ : state) {
+        ScenarioMatrix R = generateScenarios(factor, mean, scenarios, 7, 0.063);
+        benchmark::DoNotOptimize(R.column(0));
+    }
+    state.SetItemsProcessed(state.iterations() * scenarios);
+}
+BENCHMARK(BM_GenerateScenarios)->Args({500, 20000})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Portfolio P&L over the scenarios and the 99% VaR / ES selection
+void BM_ScenarioTailRisk(benchmark::State& state) {
+    const size_t assets = state.range(0), scenarios = state.range(1);
+    CholeskyFactor factor(oneFactorCovariance(assets, 5));
+    ScenarioMatrix R = generateScenarios(factor, std::vector<double>(assets, 0.0), scenarios, 7, 0.063);
+    std::vector<double> w(assets, 1.0 / assets), pnl;
+    for (auto _ : state) {
+        portfolioPnL(R, w.data(), pnl);
+        benchmark::DoNotOptimize(tailRisk(pnl, 0.01));
+    }
+    state.SetBytesProcessed(state.iterations() * 8 * assets * scenarios);
+}
+BENCHMARK(BM_ScenarioTailRisk)->Args({500, 20000})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_MeanVarianceSolve(benchmark::State& state) {
+    const size_t n = state.range(0);
+    PackedSymmetricMatrix cov = oneFactorCovariance(n, 13);
+    Philox4x32 rng(13);
+    std::vector<double> mu(n);
+    for (double& m : mu) m = 0.02 + 0.13 * rng.uniform();
+    for (auto _ : state) {
+        MeanVarianceOptimizer optimizer(cov, mu);
+        optimizer.setBounds(0.0, 0.02);
+        benchmark::DoNotOptimize(optimizer.solve(5.0));
+    }
+}
+BENCHMARK(BM_MeanVarianceSolve)->Arg(1000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
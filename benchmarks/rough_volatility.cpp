@@ -0,0 +1,122 @@
+// Rough volatility benchmarks: random numbers, Davies-Harte fBM, hybrid-
+// scheme rough Bergomi paths stored and streamed
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "../common/aligned.h"
+#include "../common/quasi_random.h"
+#include "../common/random.h"
+#include "../common/thread_pool.h"
+#include "../research_projects/fractional_brownian_motion.h"
+#include "../research_projects/path_consumers.h"
+#include "../research_projects/path_matrix.h"
+#include "../research_projects/rough_bergomi.h"
+
+namespace {
+
+constexpr size_t block = 4096;
+
+void BM_PhiloxNormal(benchmark::State& state) {
+    Philox4x32 rng(7);
+    AlignedVector<double> out(block);
+    for (auto _ : state) {
+        for (double& x : out) x = rng.normal();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_PhiloxNormal);
+
+void BM_PhiloxFillNormal(benchmark::State& state) {
+    Philox4x32 rng(7);
+    AlignedVector<double> out(block);
+    for (auto _ : state) {
+        rng.fillNormal(out.data(), block);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_PhiloxFillNormal);
+
+void BM_PhiloxFillUniform(benchmark::State& state) {
+    Philox4x32 rng(7);
+    AlignedVector<double> out(block);
+    for (auto _ : state) {
+        rng.fillUniform(out.data(), block);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_PhiloxFillUniform);
+
+// Sobol points in 16 dimensions mapped to normals by the inverse CDF
+void BM_SobolNormals(benchmark::State& state) {
+    const size_t dims = 16;
+    SobolSequence sobol(dims);
+    AlignedVector<double> out(block);
+    for (auto _ : state) {
+        for (size_t i = 0; i < block; i += dims) sobol.next(&out[i]);
+        inverseNormalCdf(out.data(), out.data(), block);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_SobolNormals);
+
+void BM_BrownianBridge(benchmark::State& state) {
+    const size_t steps = state.range(0), paths = block / steps;
+    BrownianBridge bridge(steps);
+    AlignedVector<double> z(block), increments(block);
+    Philox4x32(7).fillNormal(z.data(), block);
+    for (auto _ : state) {
+        bridge.build(z.data(), increments.data(), paths);
+        benchmark::DoNotOptimize(increments.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+BENCHMARK(BM_BrownianBridge)->Arg(64)->Arg(256);
+
+// A batch of 1024 fBM paths, H = 0.1, n steps
+void BM_FbmDaviesHarte(benchmark::State& state) {
+    PathMatrix batch(1024, state.range(0));
+    uint64_t first = 0;
+    for (auto _ : state) {
+        generateFbm(batch, 0.1, 1.0, 2018, first);
+        first += batch.paths();
+    }
+    state.SetItemsProcessed(state.iterations() * batch.paths());
+}
+BENCHMARK(BM_FbmDaviesHarte)->Arg(252)->Arg(1000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Stored spot paths by thread count, 4096 paths x 252 steps
+void BM_RoughBergomiPaths(benchmark::State& state) {
+    ThreadPool pool(state.range(0));
+    const size_t paths = 4096, steps = 252;
+    RoughBergomiEngine engine({0.1, 1.9, -0.9, 0.04}, 1.0, steps);
+    PathMatrix spot(paths, steps);
+    for (auto _ : state) {
+        engine.simulate(spot, nullptr, 100.0, 2018, 0, pool);
+        benchmark::DoNotOptimize(spot.path(0));
+    }
+    state.SetItemsProcessed(state.iterations() * paths);
+}
+BENCHMARK(BM_RoughBergomiPaths)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Asian and barrier payoffs streamed from the engine without storing paths
+void BM_RoughBergomiStream(benchmark::State& state) {
+    const size_t paths = 16384, steps = 252;
+    RoughBergomiEngine engine({0.1, 1.9, -0.9, 0.04}, 1.0, steps);
+    PathConsumers<AsianCall, UpAndOutCall> consumers(AsianCall(100.0), UpAndOutCall(100.0, 120.0));
+    for (auto _ : state) {
+        auto result = engine.stream(paths, 100.0, 2018, consumers, defaultThreadPool());
+        benchmark::DoNotOptimize(result.get<0>().payoff.mean());
+    }
+    state.SetItemsProcessed(state.iterations() * paths);
+}
+BENCHMARK(BM_RoughBergomiStream)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
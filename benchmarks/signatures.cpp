@@ -0,0 +1,120 @@
+// Signature benchmarks: truncated signatures and log-signatures, streaming
+// regime distance, batch features and signature-kernel solves
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "../common/random.h"
+#include "../research_projects/signature.h"
+#include "../research_projects/signature_kernel.h"
+#include "../research_projects/signature_methods.h"
+
+namespace {
+
+// count random-walk paths of points x dim, row-major
+std::vector<double> randomWalks(size_t count, size_t points, size_t dim, uint64_t seed) {
+    Philox4x32 rng(seed);
+    std::vector<double> walks(count * points * dim, 0.0);
+    for (size_t p = 0; p < count; ++p) {
+        double* row = &walks[p * points * dim];
+        for (size_t i = 1; i < points; ++i) {
+            for (size_t c = 0; c < dim; ++c) row[i * dim + c] = row[(i - 1) * dim + c] + 0.05 * rng.normal();
+        }
+    }
+    return walks;
+}
+
+// One 390-point path per iteration; arguments are dimension and level
+void BM_Signature(benchmark::State& state) {
+    const size_t dim = state.range(0), level = state.range(1), points = 390;
+    SignatureEngine engine(dim, level);
+    const std::vector<double> path = randomWalks(1, points, dim, 19);
+    std::vector<double> sig(engine.size());
+    for (auto _ : state) {
+        engine.compute(path.data(), points, sig.data());
+        benchmark::DoNotOptimize(sig.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (points - 1));
+}
+BENCHMARK(BM_Signature)->Args({2, 3})->Args({2, 5})->Args({4, 4})->Args({8, 3})->Args({8, 5});
+
+// Logarithm and Lyndon projection of one signature
+void BM_LogSignature(benchmark::State& state) {
+    const size_t dim = state.range(0), level = state.range(1), points = 50;
+    auto basis = LyndonBasis::get(dim, level);
+    const std::vector<double> path = randomWalks(1, points, dim, 22);
+    std::vector<double> sig(basis->engine().size()), coords(basis->size());
+    basis->engine().compute(path.data(), points, sig.data());
+    for (auto _ : state) {
+        basis->logSignature(sig.data(), coords.data());
+        benchmark::DoNotOptimize(coords.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogSignature)->Args({2, 3})->Args({2, 5})->Args({4, 4})->Args({8, 3});
+
+void BM_RegimeStreamUpdate(benchmark::State& state) {
+    const size_t ticks = 1 << 16;
+    Philox4x32 rng(20);
+    std::vector<double> prices(ticks);
+    double last = 100.0;
+    for (double& p : prices) p = last *= std::exp(0.001 * rng.normal());
+    SignatureRegimeStream stream(20);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(stream.update(prices[i]));
+        i = (i + 1) % ticks;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegimeStreamUpdate);
+
+// Log-signature features for instruments x 390 bars on the default pool
+void BM_FeatureBatch(benchmark::State& state) {
+    const size_t instruments = state.range(0), bars = 390;
+    Philox4x32 rng(21);
+    std::vector<double> prices(instruments * bars);
+    for (size_t k = 0; k < instruments; ++k) {
+        double* row = &prices[k * bars];
+        row[0] = 100.0;
+        for (size_t i = 1; i < bars; ++i) row[i] = row[i - 1] * std::exp(0.001 * rng.normal());
+    }
+    SignatureBasedPredictor predictor(3);
+    std::vector<double> features(instruments * predictor.featureCount());
+    for (auto _ : state) {
+        predictor.extractFeatures(prices.data(), instruments, bars, features.data());
+        benchmark::DoNotOptimize(features.data());
+    }
+    state.SetItemsProcessed(state.iterations() * instruments);
+}
+BENCHMARK(BM_FeatureBatch)->Arg(2000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// One Goursat solve between two-dimensional paths of n steps; items are
+// grid cells
+void BM_SignatureKernel(benchmark::State& state) {
+    const size_t steps = state.range(0), dim = 2;
+    const std::vector<double> walks = randomWalks(2, steps + 1, dim, 23);
+    KernelPaths X(walks.data(), 1, steps + 1, dim), Y(&walks[(steps + 1) * dim], 1, steps + 1, dim);
+    for (auto _ : state) benchmark::DoNotOptimize(signatureKernel(X, 0, Y, 0));
+    state.SetItemsProcessed(state.iterations() * steps * steps);
+}
+BENCHMARK(BM_SignatureKernel)->Arg(20)->Arg(100)->Arg(500);
+
+void BM_SignatureGram(benchmark::State& state) {
+    const size_t paths = state.range(0), steps = 100, dim = 2;
+    const std::vector<double> walks = randomWalks(paths, steps + 1, dim, 23);
+    KernelPaths X(walks.data(), paths, steps + 1, dim);
+    std::vector<double> gram(paths * paths);
+    for (auto _ : state) {
+        signatureGram(X, gram.data());
+        benchmark::DoNotOptimize(gram.data());
+    }
+    state.SetItemsProcessed(state.iterations() * paths * (paths + 1) / 2);
+}
+BENCHMARK(BM_SignatureGram)->Arg(100)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+// Radix-2 complex FFT on split real/imaginary arrays
+// A plan precomputes the bit-reversal permutation and one contiguous twiddle
+// table per stage, so every butterfly loop is a unit-stride SIMD loop.
+// Transforms are unnormalized; inverse(forward(x)) = size * x.
+
+#pragma once
+
+#include "aligned.h"
+#include "simd.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+class FftPlan {
+private:
+    size_t n = 0;
+    std::vector<uint32_t> bitReverse;
+    AlignedVector<double> twiddleRe, twiddleIm;   // stage with half-size h starts at h - 1
+
+    void permute(double* re, double* im) const {
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = bitReverse[i];
+            if (i < j) {
+                std::swap(re[i], re[j]);
+                std::swap(im[i], im[j]);
+            }
+        }
+    }
+
+    template <class V>
+    static void butterflies(double* re, double* im, const double* wr, const double* wi, size_t half) {
+        for (size_t j = 0; j < half; j += V::width) {
+            V ar = V::load(re + j), ai = V::load(im + j);
+            V br = V::load(re + j + half), bi = V::load(im + j + half);
+            V cr = V::load(wr + j), ci = V::load(wi + j);
+            V tr = simd::fma(br, cr, -(bi * ci));
+            V ti = simd::fma(br, ci, bi * cr);
+            (ar + tr).store(re + j);
+            (ai + ti).store(im + j);
+            (ar - tr).store(re + j + half);
+            (ai - ti).store(im + j + half);
+        }
+    }
+
+public:
+    FftPlan() = default;
+
+    explicit FftPlan(size_t size) : n(size), bitReverse(size) {
+        if (size == 0 || (size & (size - 1)) != 0) {
+            throw std::invalid_argument("FftPlan: size must be a power of two");
+        }
+        int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1u) << (bits - 1 - b);
+            bitReverse[i] = r;
+        }
+
+        twiddleRe.resize(n > 1 ? n - 1 : 1);
+        twiddleIm.resize(twiddleRe.size());
+        for (size_t half = 1; half < n; half *= 2) {
+            for (size_t j = 0; j < half; ++j) {
+                double angle = -M_PI * static_cast<double>(j) / static_cast<double>(half);
+                twiddleRe[half - 1 + j] = std::cos(angle);
+                twiddleIm[half - 1 + j] = std::sin(angle);
+            }
+        }
+    }
+
+    size_t size() const { return n; }
+
+    // In place: X_k = sum_j x_j exp(-2 pi i jk / n)
+    void forward(double* re, double* im) const {
+        using V = simd::Native;
+        permute(re, im);
+        for (size_t half = 1; half < n; half *= 2) {
+            const double* wr = &twiddleRe[half - 1];
+            const double* wi = &twiddleIm[half - 1];
+            for (size_t start = 0; start < n; start += 2 * half) {
+                if (half >= static_cast<size_t>(V::width)) {
+                    butterflies<V>(re + start, im + start, wr, wi, half);
+                } else {
+                    butterflies<simd::Scalar>(re + start, im + start, wr, wi, half);
+                }
+            }
+        }
+    }
+
+    // In place: x_j = sum_k X_k exp(+2 pi i jk / n), via conj(F(conj(X)))
+    void inverse(double* re, double* im) const { forward(im, re); }
+};
@@ -0,0 +1,117 @@
+// Blocked SIMD matrix multiply, C = beta * C + A * B, all row-major
+// A 4 x (2 vectors) register tile of C accumulates broadcast(A[i][k]) * B[k][j..]
+// over a cache block of k; B rows are read contiguously, so no packing is
+// needed for the narrow matrices of small networks. Edges fall back to one
+// vector, then to scalars; a single output column becomes row dot products.
+// Transposed operands are handled by transposing into caller-provided
+// scratch, which keeps one kernel for every case.
+
+#pragma once
+
+#include "simd.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace gemm {
+
+constexpr size_t rowTile = 4;
+constexpr size_t depthBlock = 256;
+
+namespace detail {
+
+// rows x (vectors * V::width) tile of C over k in [k0, k1), starting from
+// C when accumulate is set and from zero otherwise
+template <class V, size_t Rows, size_t Vectors>
+inline void tile(const double* A, size_t lda, const double* B, size_t ldb, double* C, size_t ldc,
+                 size_t k0, size_t k1, bool accumulate) {
+    V acc[Rows][Vectors];
+    for (size_t r = 0; r < Rows; ++r) {
+        for (size_t v = 0; v < Vectors; ++v) acc[r][v] = accumulate ? V::load(C + r * ldc + v * V::width) : V(0.0);
+    }
+    for (size_t k = k0; k < k1; ++k) {
+        V b[Vectors];
+        for (size_t v = 0; v < Vectors; ++v) b[v] = V::load(B + k * ldb + v * V::width);
+        for (size_t r = 0; r < Rows; ++r) {
+            V a(A[r * lda + k]);
+            for (size_t v = 0; v < Vectors; ++v) acc[r][v] = simd::fma(a, b[v], acc[r][v]);
+        }
+    }
+    for (size_t r = 0; r < Rows; ++r) {
+        for (size_t v = 0; v < Vectors; ++v) acc[r][v].store(C + r * ldc + v * V::width);
+    }
+}
+
+// All columns of a band of Rows rows
+template <size_t Rows>
+inline void band(const double* A, size_t lda, const double* B, size_t ldb, double* C, size_t ldc, size_t N,
+                 size_t k0, size_t k1, bool accumulate) {
+    using V = simd::Native;
+    size_t j = 0;
+    for (; j + 2 * V::width <= N; j += 2 * V::width) {
+        tile<V, Rows, 2>(A, lda, B + j, ldb, C + j, ldc, k0, k1, accumulate);
+    }
+    for (; j + V::width <= N; j += V::width) tile<V, Rows, 1>(A, lda, B + j, ldb, C + j, ldc, k0, k1, accumulate);
+    for (; j < N; ++j) tile<simd::Scalar, Rows, 1>(A, lda, B + j, ldb, C + j, ldc, k0, k1, accumulate);
+}
+
+// Partial dot product of a and b over whole pairs of vectors from k
+template <class V>
+inline V dotBody(const double* a, const double* b, size_t K, size_t& k) {
+    V acc0(0.0), acc1(0.0);
+    for (; k + 2 * V::width <= K; k += 2 * V::width) {
+        acc0 = simd::fma(V::load(a + k), V::load(b + k), acc0);
+        acc1 = simd::fma(V::load(a + k + V::width), V::load(b + k + V::width), acc1);
+    }
+    return acc0 + acc1;
+}
+
+// C[i] = beta * C[i] + A row i . b for a single contiguous column b
+inline void column(size_t M, size_t K, const double* A, size_t lda, const double* b, double* C, size_t ldc,
+                   double beta) {
+    for (size_t i = 0; i < M; ++i) {
+        const double* a = A + i * lda;
+        size_t k = 0;
+        double sum = simd::reduceAdd(dotBody<simd::Native>(a, b, K, k));
+        for (; k < K; ++k) sum += a[k] * b[k];
+        C[i * ldc] = beta != 0.0 ? C[i * ldc] + sum : sum;
+    }
+}
+
+} // namespace detail
+
+// C (M x N) = beta * C + A (M x K) * B (K x N); beta is 0 or 1
+inline void multiply(size_t M, size_t N, size_t K, const double* A, size_t lda, const double* B, size_t ldb,
+                     double* C, size_t ldc, double beta = 0.0) {
+    if (N == 1 && ldb == 1) {
+        detail::column(M, K, A, lda, B, C, ldc, beta);
+        return;
+    }
+    if (K == 0 && beta == 0.0) {
+        for (size_t i = 0; i < M; ++i) std::fill(C + i * ldc, C + i * ldc + N, 0.0);
+    }
+    for (size_t k0 = 0; k0 < K; k0 += depthBlock) {
+        const size_t k1 = std::min(K, k0 + depthBlock);
+        const bool accumulate = k0 > 0 || beta != 0.0;
+        size_t i = 0;
+        for (; i + rowTile <= M; i += rowTile) {
+            detail::band<rowTile>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, N, k0, k1, accumulate);
+        }
+        for (; i < M; ++i) detail::band<1>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, N, k0, k1, accumulate);
+    }
+}
+
+// out (cols x rows) = in (rows x cols)^T
+inline void transpose(size_t rows, size_t cols, const double* in, size_t ldin, double* out, size_t ldout) {
+    constexpr size_t block = 16;
+    for (size_t i0 = 0; i0 < rows; i0 += block) {
+        for (size_t j0 = 0; j0 < cols; j0 += block) {
+            const size_t i1 = std::min(rows, i0 + block), j1 = std::min(cols, j0 + block);
+            for (size_t i = i0; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) out[j * ldout + i] = in[i * ldin + j];
+            }
+        }
+    }
+}
+
+} // namespace gemm
@@ -0,0 +1,194 @@
+// Quasi-random paths: Sobol points and Brownian-bridge construction
+// SobolSequence produces the Sobol low-discrepancy points in up to 21
+// dimensions with the Joe-Kuo direction numbers (new-joe-kuo-6.21201), one
+// XOR per coordinate per point in Gray-code order (Antonov & Saleev 1979).
+// Any index can be reached directly, so chunk c of a parallel run starts at
+// its own first index and the points do not depend on the thread count.
+// BrownianBridge turns standard normals into Brownian increments by fixing
+// the endpoint first and then filling midpoints, so the first coordinates
+// carry most of the path's variance; feeding those from a Sobol point puts
+// the low-discrepancy dimensions where they matter (Glasserman 2004, 5.5).
+
+#pragma once
+
+#include "aligned.h"
+#include "simd.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+class SobolSequence {
+public:
+    static constexpr size_t maxDimension = 21;
+
+private:
+    static constexpr size_t bits = 32;
+
+    // Degree s, coefficients a and initial direction numbers m of the
+    // primitive polynomial for dimensions 2, 3, ...
+    struct Polynomial {
+        uint32_t degree, coefficients;
+        std::array<uint32_t, 7> initial;
+    };
+
+    static constexpr Polynomial polynomials[maxDimension - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    };
+
+    size_t d;
+    std::vector<uint32_t> direction;   // d x bits, scaled to the top bit
+    std::vector<uint32_t> state;       // current point as 32-bit fractions
+    uint64_t index;
+
+public:
+    // Points first, first + 1, ... of the sequence; point 0 is the origin,
+    // which an inverse CDF cannot map, so by default it is skipped
+    explicit SobolSequence(size_t dimensions, uint64_t first = 1)
+        : d(dimensions), direction(dimensions * bits), state(dimensions) {
+        if (d == 0 || d > maxDimension) throw std::invalid_argument("SobolSequence: 1 to 21 dimensions");
+        for (size_t k = 0; k < bits; ++k) direction[k] = uint32_t(1) << (bits - 1 - k);
+        for (size_t j = 1; j < d; ++j) {
+            const Polynomial& poly = polynomials[j - 1];
+            const size_t s = poly.degree;
+            uint32_t* v = &direction[j * bits];
+            for (size_t k = 0; k < s; ++k) v[k] = poly.initial[k] << (bits - 1 - k);
+            for (size_t k = s; k < bits; ++k) {
+                v[k] = v[k - s] ^ (v[k - s] >> s);
+                for (size_t i = 1; i < s; ++i) {
+                    if ((poly.coefficients >> (s - 1 - i)) & 1) v[k] ^= v[k - i];
+                }
+            }
+        }
+        skipTo(first);
+    }
+
+    size_t dimension() const { return d; }
+    uint64_t position() const { return index; }
+
+    // The Gray-code point g(i) = i ^ (i >> 1) XORs the directions of its set bits
+    void skipTo(uint64_t i) {
+        if (i >> bits) throw std::invalid_argument("SobolSequence: index beyond 2^32");
+        index = i;
+        const uint64_t gray = i ^ (i >> 1);
+        for (size_t j = 0; j < d; ++j) {
+            uint32_t x = 0;
+            for (size_t k = 0; k < bits; ++k) {
+                if ((gray >> k) & 1) x ^= direction[j * bits + k];
+            }
+            state[j] = x;
+        }
+    }
+
+    // point[0, dimension()) in [0, 1), then advance; consecutive Gray codes
+    // differ in the bit of the lowest zero bit of the index
+    void next(double* point) {
+        for (size_t j = 0; j < d; ++j) point[j] = state[j] * (1.0 / 4294967296.0);
+        if (++index >> bits) throw std::runtime_error("SobolSequence: exhausted 2^32 points");
+        size_t k = 0;
+        while (((index - 1) >> k) & 1) ++k;
+        for (size_t j = 0; j < d; ++j) state[j] ^= direction[j * bits + k];
+    }
+};
+
+// Brownian bridge on unit time steps t = 1, ..., steps: coordinate 0 fixes
+// W(steps), and each later coordinate fills the midpoint of an interval
+// between two points already known,
+//   W(l) = wl W(j) + wr W(k) + sigma z,
+// in the order of QuantLib's BrownianBridge
+class BrownianBridge {
+private:
+    size_t n;
+    std::vector<size_t> bridgeIndex, leftIndex, rightIndex;
+    std::vector<double> leftWeight, rightWeight, stdDev;
+
+    // out = wl left + wr right + sigma z
+    template <class V>
+    static void fill(const double* left, double wl, const double* right, double wr, const double* z, double sigma,
+                     double* out, size_t p) {
+        V x = simd::fma(V(wr), V::load(right + p), V(sigma) * V::load(z + p));
+        simd::fma(V(wl), V::load(left + p), x).store(out + p);
+    }
+
+public:
+    explicit BrownianBridge(size_t steps)
+        : n(steps), bridgeIndex(steps), leftIndex(steps), rightIndex(steps), leftWeight(steps),
+          rightWeight(steps), stdDev(steps) {
+        if (n == 0) throw std::invalid_argument("BrownianBridge: steps must be positive");
+        // Point i sits at time i + 1; map[i] != 0 once it is placed
+        std::vector<size_t> map(n, 0);
+        map[n - 1] = 1;
+        bridgeIndex[0] = n - 1;
+        stdDev[0] = std::sqrt(static_cast<double>(n));
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            while (map[j]) ++j;
+            size_t k = j;
+            while (!map[k]) ++k;
+            // Points [j, k) are unknown and k is known; place the midpoint l
+            const size_t l = j + ((k - 1 - j) >> 1);
+            map[l] = i;
+            bridgeIndex[i] = l;
+            leftIndex[i] = j;
+            rightIndex[i] = k;
+            const double tl = l + 1.0, tk = k + 1.0, tj = static_cast<double>(j);   // tj = time of point j - 1
+            leftWeight[i] = (tk - tl) / (tk - tj);
+            rightWeight[i] = (tl - tj) / (tk - tj);
+            stdDev[i] = std::sqrt((tl - tj) * (tk - tl) / (tk - tj));
+            j = k + 1;
+            if (j >= n) j = 0;
+        }
+    }
+
+    size_t size() const { return n; }
+
+    // increments (steps x paths, row-major) of unit-variance Brownian motion
+    // from z (steps x paths); row i of z is bridge coordinate i, so paths is
+    // the vector dimension. increments may not alias z.
+    void build(const double* z, double* increments, size_t paths) const {
+        using V = simd::Native;
+        // Levels W(t) first, left in increments
+        double* last = increments + (n - 1) * paths;
+        for (size_t p = 0; p < paths; ++p) last[p] = stdDev[0] * z[p];
+        for (size_t i = 1; i < n; ++i) {
+            const size_t j = leftIndex[i];
+            const double* right = increments + rightIndex[i] * paths;
+            // W(0) = 0: a bridge from the origin reuses the right row with weight 0
+            const double* left = j > 0 ? increments + (j - 1) * paths : right;
+            const double wl = j > 0 ? leftWeight[i] : 0.0;
+            const double* zi = z + i * paths;
+            double* out = increments + bridgeIndex[i] * paths;
+            size_t p = 0;
+            for (; p + V::width <= paths; p += V::width) {
+                fill<V>(left, wl, right, rightWeight[i], zi, stdDev[i], out, p);
+            }
+            for (; p < paths; ++p) fill<simd::Scalar>(left, wl, right, rightWeight[i], zi, stdDev[i], out, p);
+        }
+        for (size_t i = n; i-- > 1;) {
+            double* row = increments + i * paths;
+            const double* previous = row - paths;
+            for (size_t p = 0; p < paths; ++p) row[p] -= previous[p];
+        }
+    }
+};
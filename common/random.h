@@ -0,0 +1,324 @@
+// Counter-based random number generation
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+// SC 2011). Each (seed, stream) pair is an independent sequence, so a
+// simulation split into fixed chunks gives the same numbers whatever the
+// thread count. A block depends only on its counter, so bulk draws run the
+// rounds on several consecutive counters at once, one per SIMD lane, and
+// produce exactly the numbers the one-at-a-time calls would.
+
+#pragma once
+
+#include "simd.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace philox {
+
+constexpr uint32_t multiplier0 = 0xD2511F53u, multiplier1 = 0xCD9E8D57u;
+constexpr uint32_t weyl0 = 0x9E3779B9u, weyl1 = 0xBB67AE85u;
+
+// One block per 64-bit lane holding a 32-bit word, so each 32 x 32 -> 64
+// bit product of a round is one instruction
+#if defined(__AVX512F__)
+struct Lanes {
+    using I = __m512i;
+    static constexpr size_t width = 8;
+    static I set(uint64_t x) { return _mm512_set1_epi64(static_cast<long long>(x)); }
+    static I offsets() { return _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0); }
+    static I add(I a, I b) { return _mm512_add_epi64(a, b); }
+    static I mul(I a, I b) { return _mm512_mul_epu32(a, b); }
+    static I high(I a) { return _mm512_srli_epi64(a, 32); }
+    static I low(I a) { return _mm512_and_si512(a, set(0xFFFFFFFFu)); }
+    static I bitXor(I a, I b) { return _mm512_xor_si512(a, b); }
+
+    // ((a >> 5) 2^26 + (b >> 6) + 1/2) 2^-53, exactly as uniform() forms it
+    static void uniform(I a, I b, double* out) {
+        const I magic = set(0x4330000000000000ull);
+        const __m512d two52 = _mm512_set1_pd(4503599627370496.0);
+        __m512d hi = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(a, 5), magic)), two52);
+        __m512d lo = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(b, 6), magic)), two52);
+        __m512d v = _mm512_add_pd(_mm512_fmadd_pd(hi, _mm512_set1_pd(67108864.0), lo), _mm512_set1_pd(0.5));
+        _mm512_storeu_pd(out, _mm512_mul_pd(v, _mm512_set1_pd(1.0 / 9007199254740992.0)));
+    }
+};
+#elif defined(__AVX2__) && defined(__FMA__)
+struct Lanes {
+    using I = __m256i;
+    static constexpr size_t width = 4;
+    static I set(uint64_t x) { return _mm256_set1_epi64x(static_cast<long long>(x)); }
+    static I offsets() { return _mm256_set_epi64x(3, 2, 1, 0); }
+    static I add(I a, I b) { return _mm256_add_epi64(a, b); }
+    static I mul(I a, I b) { return _mm256_mul_epu32(a, b); }
+    static I high(I a) { return _mm256_srli_epi64(a, 32); }
+    static I low(I a) { return _mm256_and_si256(a, set(0xFFFFFFFFu)); }
+    static I bitXor(I a, I b) { return _mm256_xor_si256(a, b); }
+
+    static void uniform(I a, I b, double* out) {
+        const I magic = set(0x4330000000000000ull);
+        const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+        __m256d hi = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(a, 5), magic)), two52);
+        __m256d lo = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(b, 6), magic)), two52);
+        __m256d v = _mm256_add_pd(_mm256_fmadd_pd(hi, _mm256_set1_pd(67108864.0), lo), _mm256_set1_pd(0.5));
+        _mm256_storeu_pd(out, _mm256_mul_pd(v, _mm256_set1_pd(1.0 / 9007199254740992.0)));
+    }
+};
+#endif
+
+// u1[b], u2[b] = the two uniforms of the block with counter first + b, for
+// as many whole groups of lanes as fit in count; returns how many were done
+inline size_t uniformPairs(uint64_t first, uint32_t stream0, uint32_t stream1, uint32_t key0, uint32_t key1,
+                           double* u1, double* u2, size_t count) {
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+    using L = Lanes;
+    using I = L::I;
+    I roundKey0[10], roundKey1[10];
+    for (int r = 0; r < 10; ++r) {
+        roundKey0[r] = L::set(key0);
+        roundKey1[r] = L::set(key1);
+        key0 += weyl0;
+        key1 += weyl1;
+    }
+    const I m0 = L::set(multiplier0), m1 = L::set(multiplier1);
+    const I s0 = L::set(stream0), s1 = L::set(stream1);
+    I index = L::add(L::set(first), L::offsets());
+    const size_t bulk = count / L::width * L::width;
+    for (size_t b = 0; b < bulk; b += L::width) {
+        I x0 = L::low(index), x1 = L::high(index), x2 = s0, x3 = s1;
+        for (int r = 0; r < 10; ++r) {
+            const I p0 = L::mul(x0, m0), p1 = L::mul(x2, m1);
+            x0 = L::bitXor(L::bitXor(L::high(p1), x1), roundKey0[r]);
+            x1 = L::low(p1);
+            x2 = L::bitXor(L::bitXor(L::high(p0), x3), roundKey1[r]);
+            x3 = L::low(p0);
+        }
+        L::uniform(x0, x1, u1 + b);
+        L::uniform(x2, x3, u2 + b);
+        index = L::add(index, L::set(L::width));
+    }
+    return bulk;
+#else
+    (void)first, (void)stream0, (void)stream1, (void)key0, (void)key1, (void)u1, (void)u2, (void)count;
+    return 0;
+#endif
+}
+
+} // namespace philox
+
+class Philox4x32 {
+private:
+    std::array<uint32_t, 4> counter;
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> block;
+    int used = 4;
+
+    bool hasSpareNormal = false;
+    double spareNormal = 0.0;
+
+    static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+        uint64_t product = static_cast<uint64_t>(a) * b;
+        hi = static_cast<uint32_t>(product >> 32);
+        lo = static_cast<uint32_t>(product);
+    }
+
+    void refill() {
+        std::array<uint32_t, 4> x = counter;
+        std::array<uint32_t, 2> k = key;
+        for (int round = 0; round < 10; ++round) {
+            uint32_t hi0, lo0, hi1, lo1;
+            mulhilo(philox::multiplier0, x[0], hi0, lo0);
+            mulhilo(philox::multiplier1, x[2], hi1, lo1);
+            x = {hi1 ^ x[1] ^ k[0], lo1, hi0 ^ x[3] ^ k[1], lo0};
+            k[0] += philox::weyl0;
+            k[1] += philox::weyl1;
+        }
+        block = x;
+        used = 0;
+
+        // 64-bit block index in the low words
+        if (++counter[0] == 0) ++counter[1];
+    }
+
+    // u1[i], u2[i] = successive pairs of uniform() for i in [0, count); whole
+    // blocks go through the SIMD rounds when no block is partly used
+    void uniformPairs(double* u1, double* u2, size_t count) {
+        size_t i = 0;
+        if (used == 4) {
+            uint64_t index = counter[0] | static_cast<uint64_t>(counter[1]) << 32;
+            i = philox::uniformPairs(index, counter[2], counter[3], key[0], key[1], u1, u2, count);
+            index += i;
+            counter[0] = static_cast<uint32_t>(index);
+            counter[1] = static_cast<uint32_t>(index >> 32);
+        }
+        for (; i < count; ++i) {
+            u1[i] = uniform();
+            u2[i] = uniform();
+        }
+    }
+
+public:
+    using result_type = uint32_t;
+
+    // stream selects an independent substream, e.g. a chunk or thread index
+    explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0)
+        : counter{0u, 0u, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)},
+          key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint32_t>::max(); }
+
+    result_type operator()() {
+        if (used == 4) refill();
+        return block[used++];
+    }
+
+    // Uniform on the open interval (0, 1) with 53 bits of resolution
+    double uniform() {
+        uint64_t hi = (*this)() >> 5;
+        uint64_t lo = (*this)() >> 6;
+        return ((hi << 26 | lo) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+    // Standard normal via Box-Muller, two draws per pair of uniforms
+    double normal() {
+        if (hasSpareNormal) {
+            hasSpareNormal = false;
+            return spareNormal;
+        }
+        double radius = std::sqrt(-2.0 * std::log(uniform()));
+        double angle = 6.283185307179586 * uniform();
+        spareNormal = radius * std::sin(angle);
+        hasSpareNormal = true;
+        return radius * std::cos(angle);
+    }
+
+    // count uniforms, the same values as count calls to uniform()
+    void fillUniform(double* out, size_t count) {
+        constexpr size_t block = 256;
+        alignas(64) double u1[block], u2[block];
+        while (count >= 2) {
+            const size_t pairs = std::min(block, count / 2);
+            uniformPairs(u1, u2, pairs);
+            for (size_t i = 0; i < pairs; ++i) {
+                out[2 * i] = u1[i];
+                out[2 * i + 1] = u2[i];
+            }
+            out += 2 * pairs;
+            count -= 2 * pairs;
+        }
+        if (count > 0) *out = uniform();
+    }
+
+    // Bulk standard normals: Box-Muller over a block of uniforms with the
+    // SIMD log/sqrt/sincos kernels. Draws a different sequence than normal().
+    void fillNormal(double* out, size_t count) {
+        using V = simd::Native;
+        constexpr size_t block = 256;
+        alignas(64) double u1[block], u2[block];
+        while (count > 0) {
+            const size_t pairs = std::min(block, (count + 1) / 2);
+            const size_t rounded = (pairs + V::width - 1) / V::width * V::width;
+            uniformPairs(u1, u2, rounded);
+            for (size_t i = 0; i < rounded; i += V::width) {
+                V radius = simd::sqrt(V(-2.0) * simd::log(V::load(u1 + i)));
+                V sine, cosine;
+                simd::sinCos2Pi(V::load(u2 + i), sine, cosine);
+                (radius * cosine).store(u1 + i);
+                (radius * sine).store(u2 + i);
+            }
+            const size_t produced = std::min(count, 2 * pairs);
+            const size_t first = std::min(produced, pairs);
+            std::copy(u1, u1 + first, out);
+            std::copy(u2, u2 + (produced - first), out + first);
+            out += produced;
+            count -= produced;
+        }
+    }
+};
+
+// Inverse of the standard normal CDF (Acklam's rational approximation with
+// one Halley refinement step, ~1e-15 relative error)
+inline double inverseNormalCdf(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425;
+
+    double x;
+    if (p < low) {
+        double q = std::sqrt(-2 * std::log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    } else if (p <= 1 - low) {
+        double q = p - 0.5, r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    } else {
+        double q = std::sqrt(-2 * std::log(1 - p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+
+    double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    double u = e * std::sqrt(2 * M_PI) * std::exp(0.5 * x * x);
+    return x - u / (1 + 0.5 * x * u);
+}
+
+// inverseNormalCdf on a vector of probabilities: both branches of the
+// approximation are evaluated and chosen per lane, and the Halley step uses
+// the vectorized normal CDF
+template <class V>
+inline V inverseNormalCdf(V p) {
+    const V q = p - V(0.5), r = q * q;
+    V num = V(-3.969683028665376e+01);
+    num = simd::fma(num, r, V(2.209460984245205e+02));
+    num = simd::fma(num, r, V(-2.759285104469687e+02));
+    num = simd::fma(num, r, V(1.383577518672690e+02));
+    num = simd::fma(num, r, V(-3.066479806614716e+01));
+    num = simd::fma(num, r, V(2.506628277459239e+00));
+    V den = V(-5.447609879822406e+01);
+    den = simd::fma(den, r, V(1.615858368580409e+02));
+    den = simd::fma(den, r, V(-1.556989798598866e+02));
+    den = simd::fma(den, r, V(6.680131188771972e+01));
+    den = simd::fma(den, r, V(-1.328068155288572e+01));
+    den = simd::fma(den, r, V(1.0));
+    const V central = num * q / den;
+
+    // Lower-tail formula on min(p, 1 - p), negated for the upper tail
+    const V t = simd::sqrt(V(-2.0) * simd::log(simd::min(p, V(1.0) - p)));
+    V tn = V(-7.784894002430293e-03);
+    tn = simd::fma(tn, t, V(-3.223964580411365e-01));
+    tn = simd::fma(tn, t, V(-2.400758277161838e+00));
+    tn = simd::fma(tn, t, V(-2.549732539343734e+00));
+    tn = simd::fma(tn, t, V(4.374664141464968e+00));
+    tn = simd::fma(tn, t, V(2.938163982698783e+00));
+    V td = V(7.784695709041462e-03);
+    td = simd::fma(td, t, V(3.224671290700398e-01));
+    td = simd::fma(td, t, V(2.445134137142996e+00));
+    td = simd::fma(td, t, V(3.754408661907416e+00));
+    td = simd::fma(td, t, V(1.0));
+    const V lowerTail = tn / td;
+    const V tail = simd::select(q > V(0.0), -lowerTail, lowerTail);
+
+    V x = simd::select(simd::abs(q) <= V(0.5 - 0.02425), central, tail);
+    const V e = simd::normCdf(x) - p;
+    const V u = e * V(2.5066282746310002) * simd::exp(V(0.5) * x * x);
+    return x - u / simd::fma(V(0.5) * x, u, V(1.0));
+}
+
+// x[i] = inverseNormalCdf(p[i]) for p in (0, 1)
+inline void inverseNormalCdf(const double* p, double* x, size_t count) {
+    using V = simd::Native;
+    size_t i = 0;
+    for (; i + V::width <= count; i += V::width) inverseNormalCdf(V::load(p + i)).store(x + i);
+    for (; i < count; ++i) x[i] = inverseNormalCdf(simd::Scalar{p[i]}).v;
+}
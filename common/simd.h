@@ -0,0 +1,460 @@
+// Portable SIMD wrappers and vectorized math kernels
+// The widest instruction set enabled at compile time is used (-march=native):
+// AVX-512 (8 doubles), AVX2+FMA (4 doubles), otherwise a scalar fallback.
+// Kernels are written once as templates over the vector type so the scalar
+// type can also finish the tail of a batch.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized and -Wuninitialized on
+// the self-initialized results of _mm512_undefined_pd and _mm512_undefined_ps
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+namespace simd {
+
+// ---------------------------------------------------------------------------
+// Scalar fallback (width 1)
+// ---------------------------------------------------------------------------
+struct Scalar {
+    static constexpr int width = 1;
+    struct Mask { bool m; };
+    double v;
+
+    Scalar() = default;
+    Scalar(double x) : v(x) {}
+
+    static Scalar load(const double* p) { return {*p}; }
+    void store(double* p) const { *p = v; }
+    double lane(int) const { return v; }
+
+    friend Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+    friend Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+    friend Scalar operator*(Scalar a, Scalar b) { return {a.v * b.v}; }
+    friend Scalar operator/(Scalar a, Scalar b) { return {a.v / b.v}; }
+    friend Scalar operator-(Scalar a) { return {-a.v}; }
+    friend Mask operator<(Scalar a, Scalar b) { return {a.v < b.v}; }
+    friend Mask operator>(Scalar a, Scalar b) { return {a.v > b.v}; }
+    friend Mask operator<=(Scalar a, Scalar b) { return {a.v <= b.v}; }
+    friend Mask operator>=(Scalar a, Scalar b) { return {a.v >= b.v}; }
+};
+
+inline Scalar::Mask operator&(Scalar::Mask a, Scalar::Mask b) { return {a.m && b.m}; }
+inline Scalar::Mask operator|(Scalar::Mask a, Scalar::Mask b) { return {a.m || b.m}; }
+inline Scalar::Mask operator!(Scalar::Mask a) { return {!a.m}; }
+inline bool any(Scalar::Mask a) { return a.m; }
+inline bool all(Scalar::Mask a) { return a.m; }
+inline Scalar select(Scalar::Mask m, Scalar a, Scalar b) { return m.m ? a : b; }
+
+// std::fma is a slow library call without hardware FMA
+inline Scalar fma(Scalar a, Scalar b, Scalar c) {
+#if defined(__FMA__)
+    return {std::fma(a.v, b.v, c.v)};
+#else
+    return {a.v * b.v + c.v};
+#endif
+}
+inline Scalar sqrt(Scalar a) { return {std::sqrt(a.v)}; }
+inline Scalar abs(Scalar a) { return {std::fabs(a.v)}; }
+inline Scalar min(Scalar a, Scalar b) { return {a.v < b.v ? a.v : b.v}; }
+inline Scalar max(Scalar a, Scalar b) { return {a.v > b.v ? a.v : b.v}; }
+inline Scalar round(Scalar a) { return {std::nearbyint(a.v)}; }
+// x * 2^n for integral-valued n in the normal exponent range
+inline Scalar ldexp(Scalar x, Scalar n) {
+    uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(n.v) + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof scale);
+    return {x.v * scale};
+}
+// Split a positive normal x into mantissa in [1, 2) and unbiased exponent
+inline Scalar frexp(Scalar x, Scalar& exponent) {
+    uint64_t bits;
+    std::memcpy(&bits, &x.v, sizeof bits);
+    exponent = {static_cast<double>(static_cast<int64_t>(bits >> 52) - 1023)};
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    std::memcpy(&m, &bits, sizeof m);
+    return {m};
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 + FMA (width 4)
+// ---------------------------------------------------------------------------
+#if defined(__AVX2__) && defined(__FMA__)
+struct Avx2 {
+    static constexpr int width = 4;
+    struct Mask { __m256d m; };
+    __m256d v;
+
+    Avx2() = default;
+    Avx2(__m256d x) : v(x) {}
+    Avx2(double x) : v(_mm256_set1_pd(x)) {}
+
+    static Avx2 load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    double lane(int i) const { alignas(32) double t[4]; _mm256_store_pd(t, v); return t[i]; }
+
+    friend Avx2 operator+(Avx2 a, Avx2 b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Avx2 operator-(Avx2 a, Avx2 b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Avx2 operator*(Avx2 a, Avx2 b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    friend Avx2 operator/(Avx2 a, Avx2 b) { return {_mm256_div_pd(a.v, b.v)}; }
+    friend Avx2 operator-(Avx2 a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+    friend Mask operator<(Avx2 a, Avx2 b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+    friend Mask operator>(Avx2 a, Avx2 b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+    friend Mask operator<=(Avx2 a, Avx2 b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)}; }
+    friend Mask operator>=(Avx2 a, Avx2 b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)}; }
+};
+
+inline Avx2::Mask operator&(Avx2::Mask a, Avx2::Mask b) { return {_mm256_and_pd(a.m, b.m)}; }
+inline Avx2::Mask operator|(Avx2::Mask a, Avx2::Mask b) { return {_mm256_or_pd(a.m, b.m)}; }
+inline Avx2::Mask operator!(Avx2::Mask a) {
+    return {_mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))};
+}
+inline bool any(Avx2::Mask a) { return _mm256_movemask_pd(a.m) != 0; }
+inline bool all(Avx2::Mask a) { return _mm256_movemask_pd(a.m) == 0xF; }
+inline Avx2 select(Avx2::Mask m, Avx2 a, Avx2 b) { return {_mm256_blendv_pd(b.v, a.v, m.m)}; }
+
+inline Avx2 fma(Avx2 a, Avx2 b, Avx2 c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+inline Avx2 sqrt(Avx2 a) { return {_mm256_sqrt_pd(a.v)}; }
+inline Avx2 abs(Avx2 a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+inline Avx2 min(Avx2 a, Avx2 b) { return {_mm256_min_pd(a.v, b.v)}; }
+inline Avx2 max(Avx2 a, Avx2 b) { return {_mm256_max_pd(a.v, b.v)}; }
+inline Avx2 round(Avx2 a) {
+    return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)};
+}
+inline Avx2 ldexp(Avx2 x, Avx2 n) {
+    __m256i e = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n.v));
+    e = _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+    return {_mm256_mul_pd(x.v, _mm256_castsi256_pd(e))};
+}
+inline Avx2 frexp(Avx2 x, Avx2& exponent) {
+    const __m256i bits = _mm256_castpd_si256(x.v);
+    // Biased exponent bits reinterpreted as a double via the 2^52 trick
+    const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    __m256d e = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), magic));
+    exponent = {_mm256_sub_pd(e, _mm256_set1_pd(4503599627370496.0 + 1023.0))};
+    __m256i m = _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+    m = _mm256_or_si256(m, _mm256_set1_epi64x(0x3FF0000000000000LL));
+    return {_mm256_castsi256_pd(m)};
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// AVX-512 (width 8)
+// ---------------------------------------------------------------------------
+#if defined(__AVX512F__)
+struct Avx512 {
+    static constexpr int width = 8;
+    struct Mask { __mmask8 m; };
+    __m512d v;
+
+    Avx512() = default;
+    Avx512(__m512d x) : v(x) {}
+    Avx512(double x) : v(_mm512_set1_pd(x)) {}
+
+    static Avx512 load(const double* p) { return {_mm512_loadu_pd(p)}; }
+    void store(double* p) const { _mm512_storeu_pd(p, v); }
+    double lane(int i) const { alignas(64) double t[8]; _mm512_store_pd(t, v); return t[i]; }
+
+    friend Avx512 operator+(Avx512 a, Avx512 b) { return {_mm512_add_pd(a.v, b.v)}; }
+    friend Avx512 operator-(Avx512 a, Avx512 b) { return {_mm512_sub_pd(a.v, b.v)}; }
+    friend Avx512 operator*(Avx512 a, Avx512 b) { return {_mm512_mul_pd(a.v, b.v)}; }
+    friend Avx512 operator/(Avx512 a, Avx512 b) { return {_mm512_div_pd(a.v, b.v)}; }
+    friend Avx512 operator-(Avx512 a) { return {_mm512_sub_pd(_mm512_setzero_pd(), a.v)}; }
+    friend Mask operator<(Avx512 a, Avx512 b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)}; }
+    friend Mask operator>(Avx512 a, Avx512 b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)}; }
+    friend Mask operator<=(Avx512 a, Avx512 b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ)}; }
+    friend Mask operator>=(Avx512 a, Avx512 b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ)}; }
+};
+
+inline Avx512::Mask operator&(Avx512::Mask a, Avx512::Mask b) { return {static_cast<__mmask8>(a.m & b.m)}; }
+inline Avx512::Mask operator|(Avx512::Mask a, Avx512::Mask b) { return {static_cast<__mmask8>(a.m | b.m)}; }
+inline Avx512::Mask operator!(Avx512::Mask a) { return {static_cast<__mmask8>(~a.m)}; }
+inline bool any(Avx512::Mask a) { return a.m != 0; }
+inline bool all(Avx512::Mask a) { return a.m == 0xFF; }
+inline Avx512 select(Avx512::Mask m, Avx512 a, Avx512 b) { return {_mm512_mask_blend_pd(m.m, b.v, a.v)}; }
+
+inline Avx512 fma(Avx512 a, Avx512 b, Avx512 c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+inline Avx512 sqrt(Avx512 a) { return {_mm512_sqrt_pd(a.v)}; }
+inline Avx512 abs(Avx512 a) { return {_mm512_abs_pd(a.v)}; }
+inline Avx512 min(Avx512 a, Avx512 b) { return {_mm512_min_pd(a.v, b.v)}; }
+inline Avx512 max(Avx512 a, Avx512 b) { return {_mm512_max_pd(a.v, b.v)}; }
+inline Avx512 round(Avx512 a) { return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT)}; }
+inline Avx512 ldexp(Avx512 x, Avx512 n) { return {_mm512_scalef_pd(x.v, n.v)}; }
+inline Avx512 frexp(Avx512 x, Avx512& exponent) {
+    exponent = {_mm512_getexp_pd(x.v)};
+    return {_mm512_getmant_pd(x.v, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src)};
+}
+#endif
+
+// Widest vector type available for this build
+#if defined(__AVX512F__)
+using Native = Avx512;
+#elif defined(__AVX2__) && defined(__FMA__)
+using Native = Avx2;
+#else
+using Native = Scalar;
+#endif
+
+inline const char* nativeName() {
+    return Native::width == 8 ? "AVX-512" : Native::width == 4 ? "AVX2" : "scalar";
+}
+
+// Sum of all lanes
+template <class V>
+inline double reduceAdd(V v) {
+    double sum = 0.0;
+    for (int i = 0; i < V::width; ++i) sum += v.lane(i);
+    return sum;
+}
+
+// ---------------------------------------------------------------------------
+// Single precision (widths 1, 8 and 16) for inference kernels; arithmetic,
+// min/max and horizontal sums only
+// ---------------------------------------------------------------------------
+struct ScalarFloat {
+    static constexpr int width = 1;
+    float v;
+
+    ScalarFloat() = default;
+    ScalarFloat(float x) : v(x) {}
+
+    static ScalarFloat load(const float* p) { return {*p}; }
+    void store(float* p) const { *p = v; }
+    float lane(int) const { return v; }
+
+    friend ScalarFloat operator+(ScalarFloat a, ScalarFloat b) { return {a.v + b.v}; }
+    friend ScalarFloat operator-(ScalarFloat a, ScalarFloat b) { return {a.v - b.v}; }
+    friend ScalarFloat operator*(ScalarFloat a, ScalarFloat b) { return {a.v * b.v}; }
+};
+
+inline ScalarFloat fma(ScalarFloat a, ScalarFloat b, ScalarFloat c) {
+#if defined(__FMA__)
+    return {std::fma(a.v, b.v, c.v)};
+#else
+    return {a.v * b.v + c.v};
+#endif
+}
+inline ScalarFloat min(ScalarFloat a, ScalarFloat b) { return {a.v < b.v ? a.v : b.v}; }
+inline ScalarFloat max(ScalarFloat a, ScalarFloat b) { return {a.v > b.v ? a.v : b.v}; }
+inline float reduceAdd(ScalarFloat a) { return a.v; }
+inline float reduceMax(ScalarFloat a) { return a.v; }
+
+#if defined(__AVX2__) && defined(__FMA__)
+struct Avx2Float {
+    static constexpr int width = 8;
+    __m256 v;
+
+    Avx2Float() = default;
+    Avx2Float(__m256 x) : v(x) {}
+    Avx2Float(float x) : v(_mm256_set1_ps(x)) {}
+
+    static Avx2Float load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    float lane(int i) const { alignas(32) float t[8]; _mm256_store_ps(t, v); return t[i]; }
+
+    friend Avx2Float operator+(Avx2Float a, Avx2Float b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend Avx2Float operator-(Avx2Float a, Avx2Float b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend Avx2Float operator*(Avx2Float a, Avx2Float b) { return {_mm256_mul_ps(a.v, b.v)}; }
+};
+
+inline Avx2Float fma(Avx2Float a, Avx2Float b, Avx2Float c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+inline Avx2Float min(Avx2Float a, Avx2Float b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline Avx2Float max(Avx2Float a, Avx2Float b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline float reduceAdd(Avx2Float a) {
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_add_ss(x, _mm_movehdup_ps(x)));
+}
+inline float reduceMax(Avx2Float a) {
+    __m128 x = _mm_max_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+    x = _mm_max_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_max_ss(x, _mm_movehdup_ps(x)));
+}
+#endif
+
+#if defined(__AVX512F__)
+struct Avx512Float {
+    static constexpr int width = 16;
+    __m512 v;
+
+    Avx512Float() = default;
+    Avx512Float(__m512 x) : v(x) {}
+    Avx512Float(float x) : v(_mm512_set1_ps(x)) {}
+
+    static Avx512Float load(const float* p) { return {_mm512_loadu_ps(p)}; }
+    void store(float* p) const { _mm512_storeu_ps(p, v); }
+    float lane(int i) const { alignas(64) float t[16]; _mm512_store_ps(t, v); return t[i]; }
+
+    friend Avx512Float operator+(Avx512Float a, Avx512Float b) { return {_mm512_add_ps(a.v, b.v)}; }
+    friend Avx512Float operator-(Avx512Float a, Avx512Float b) { return {_mm512_sub_ps(a.v, b.v)}; }
+    friend Avx512Float operator*(Avx512Float a, Avx512Float b) { return {_mm512_mul_ps(a.v, b.v)}; }
+};
+
+inline Avx512Float fma(Avx512Float a, Avx512Float b, Avx512Float c) { return {_mm512_fmadd_ps(a.v, b.v, c.v)}; }
+inline Avx512Float min(Avx512Float a, Avx512Float b) { return {_mm512_min_ps(a.v, b.v)}; }
+inline Avx512Float max(Avx512Float a, Avx512Float b) { return {_mm512_max_ps(a.v, b.v)}; }
+inline float reduceAdd(Avx512Float a) { return _mm512_reduce_add_ps(a.v); }
+inline float reduceMax(Avx512Float a) { return _mm512_reduce_max_ps(a.v); }
+#endif
+
+#if defined(__AVX512F__)
+using NativeFloat = Avx512Float;
+#elif defined(__AVX2__) && defined(__FMA__)
+using NativeFloat = Avx2Float;
+#else
+using NativeFloat = ScalarFloat;
+#endif
+
+// ---------------------------------------------------------------------------
+// Math kernels (generic over the vector type)
+// ---------------------------------------------------------------------------
+
+// exp(x): range reduction x = n*ln2 + r, degree-12 Taylor polynomial on
+// |r| <= ln2/2 (~1e-16 relative error). Inputs are clamped to [-708, 708].
+template <class V>
+inline V exp(V x) {
+    x = min(max(x, V(-708.0)), V(708.0));
+    V n = round(x * V(1.4426950408889634));
+    V r = fma(n, V(-6.93145751953125e-1), x);
+    r = fma(n, V(-1.42860682030941723212e-6), r);
+
+    V p = V(1.0 / 479001600.0);
+    p = fma(p, r, V(1.0 / 39916800.0));
+    p = fma(p, r, V(1.0 / 3628800.0));
+    p = fma(p, r, V(1.0 / 362880.0));
+    p = fma(p, r, V(1.0 / 40320.0));
+    p = fma(p, r, V(1.0 / 5040.0));
+    p = fma(p, r, V(1.0 / 720.0));
+    p = fma(p, r, V(1.0 / 120.0));
+    p = fma(p, r, V(1.0 / 24.0));
+    p = fma(p, r, V(1.0 / 6.0));
+    p = fma(p, r, V(0.5));
+    p = fma(p, r, V(1.0));
+    p = fma(p, r, V(1.0));
+    return ldexp(p, n);
+}
+
+// log(x) for positive normal x: x = m * 2^e with m in [sqrt(2)/2, sqrt(2)),
+// then log(m) = 2*atanh(s), s = (m-1)/(m+1), summed as an odd series.
+template <class V>
+inline V log(V x) {
+    V e;
+    V m = frexp(x, e);
+    auto big = m > V(1.4142135623730951);
+    m = select(big, m * V(0.5), m);
+    e = select(big, e + V(1.0), e);
+
+    V s = (m - V(1.0)) / (m + V(1.0));
+    V z = s * s;
+    V p = V(1.0 / 21.0);
+    p = fma(p, z, V(1.0 / 19.0));
+    p = fma(p, z, V(1.0 / 17.0));
+    p = fma(p, z, V(1.0 / 15.0));
+    p = fma(p, z, V(1.0 / 13.0));
+    p = fma(p, z, V(1.0 / 11.0));
+    p = fma(p, z, V(1.0 / 9.0));
+    p = fma(p, z, V(1.0 / 7.0));
+    p = fma(p, z, V(1.0 / 5.0));
+    p = fma(p, z, V(1.0 / 3.0));
+    p = fma(p, z, V(1.0));
+    return fma(e, V(0.6931471805599453), V(2.0) * s * p);
+}
+
+// tanh(x) = sign(x) (1 - t) / (1 + t) with t = exp(-2|x|); ~1e-16 absolute error
+template <class V>
+inline V tanh(V x) {
+    V t = exp(V(-2.0) * abs(x));
+    V y = (V(1.0) - t) / (V(1.0) + t);
+    return select(x < V(0.0), -y, y);
+}
+
+// sin(2 pi u) and cos(2 pi u) for u in [0, 1): u = q/4 + r with |r| <= 1/8,
+// Taylor polynomials on |2 pi r| <= pi/4, then the quadrant q picks signs.
+template <class V>
+inline void sinCos2Pi(V u, V& sine, V& cosine) {
+    V q = round(u * V(4.0));
+    V x = (u - q * V(0.25)) * V(6.283185307179586);
+    V z = x * x;
+
+    V s = V(-1.0 / 1307674368000.0);
+    s = fma(s, z, V(1.0 / 6227020800.0));
+    s = fma(s, z, V(-1.0 / 39916800.0));
+    s = fma(s, z, V(1.0 / 362880.0));
+    s = fma(s, z, V(-1.0 / 5040.0));
+    s = fma(s, z, V(1.0 / 120.0));
+    s = fma(s, z, V(-1.0 / 6.0));
+    s = fma(s * z, x, x);
+
+    V c = V(1.0 / 20922789888000.0);
+    c = fma(c, z, V(-1.0 / 87178291200.0));
+    c = fma(c, z, V(1.0 / 479001600.0));
+    c = fma(c, z, V(-1.0 / 3628800.0));
+    c = fma(c, z, V(1.0 / 40320.0));
+    c = fma(c, z, V(-1.0 / 720.0));
+    c = fma(c, z, V(1.0 / 24.0));
+    c = fma(c, z, V(-0.5));
+    c = fma(c, z, V(1.0));
+
+    // Quadrants 1, 2, 3 rotate (s, c) to (c, -s), (-s, -c), (-c, s); q = 4 is 0
+    auto q1 = (q > V(0.5)) & (q < V(1.5));
+    auto q2 = (q > V(1.5)) & (q < V(2.5));
+    auto q3 = (q > V(2.5)) & (q < V(3.5));
+    sine = select(q1, c, select(q2, -s, select(q3, -c, s)));
+    cosine = select(q1, -s, select(q2, -c, select(q3, s, c)));
+}
+
+// Standard normal density
+template <class V>
+inline V normPdf(V x) {
+    return V(0.3989422804014327) * exp(V(-0.5) * x * x);
+}
+
+// Standard normal CDF, Hart (1968) double-precision rational approximation
+// as given by West (2005). Both branches are evaluated and blended.
+template <class V>
+inline V normCdf(V x) {
+    V a = abs(x);
+    V g = exp(V(-0.5) * a * a);
+
+    V num = V(3.52624965998911e-02);
+    num = fma(num, a, V(0.700383064443688));
+    num = fma(num, a, V(6.37396220353165));
+    num = fma(num, a, V(33.912866078383));
+    num = fma(num, a, V(112.079291497871));
+    num = fma(num, a, V(221.213596169931));
+    num = fma(num, a, V(220.206867912376));
+    V den = V(8.83883476483184e-02);
+    den = fma(den, a, V(1.75566716318264));
+    den = fma(den, a, V(16.064177579207));
+    den = fma(den, a, V(86.7807322029461));
+    den = fma(den, a, V(296.564248779674));
+    den = fma(den, a, V(637.333633378831));
+    den = fma(den, a, V(793.826512519948));
+    den = fma(den, a, V(440.413735824752));
+    V central = g * num / den;
+
+    // Continued fraction for the far tail
+    V cf = a + V(0.65);
+    cf = a + V(4.0) / cf;
+    cf = a + V(3.0) / cf;
+    cf = a + V(2.0) / cf;
+    cf = a + V(1.0) / cf;
+    V tail = g / (cf * V(2.506628274631));
+
+    V lower = select(a < V(7.07106781186547), central, tail);
+    lower = select(a > V(37.0), V(0.0), lower);
+    return select(x > V(0.0), V(1.0) - lower, lower);
+}
+
+} // namespace simd
@@ -0,0 +1,119 @@
+// Fixed-size thread pool with a blocking parallel-for
+// Tasks are handed out through an atomic counter, and the calling thread
+// works alongside the pool, so ThreadPool(1) runs everything inline.
+// parallelFor is meant to be driven by one caller at a time. The first
+// exception thrown by a task stops the hand-out of further indices and is
+// rethrown to the caller once every thread has left the job.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    std::atomic<size_t> nextTask{0};
+    size_t busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    void drain() {
+        for (size_t i = nextTask.fetch_add(1); i < jobCount; i = nextTask.fetch_add(1)) {
+            try {
+                (*job)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) failure = std::current_exception();
+                nextTask.store(jobCount);
+            }
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            lock.unlock();
+
+            drain();
+
+            lock.lock();
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        for (size_t i = 1; i < threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads taking part in parallelFor, including the caller
+    size_t size() const { return workers.size() + 1; }
+
+    // Run task(i) for every i in [0, count) and wait for all of them
+    void parallelFor(size_t count, const std::function<void(size_t)>& task) {
+        if (workers.empty() || count <= 1) {
+            for (size_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &task;
+            jobCount = count;
+            nextTask.store(0);
+            busyWorkers = workers.size();
+            failure = nullptr;
+            ++generation;
+        }
+        wake.notify_all();
+        drain();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return busyWorkers == 0; });
+        job = nullptr;
+        if (failure) {
+            std::exception_ptr error = std::move(failure);
+            failure = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Process-wide pool sized to the machine
+inline ThreadPool& defaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
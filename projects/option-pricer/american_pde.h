@@ -0,0 +1,223 @@
+// Crank-Nicolson finite-difference pricer with early exercise
+// Solves the Black-Scholes PDE in log-spot on a uniform grid centred on the
+// spot. Early exercise uses the Brennan-Schwartz projected Thomas step, and
+// the first steps are fully implicit (Rannacher) to damp the payoff kink.
+// The grid and tridiagonal workspace are allocated once per solver and reused
+// for every contract, so pricing does no allocation.
+
+#pragma once
+
+#include "option.h"
+#include "vanilla_option.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+// Exercise style tag for early exercise at any time up to expiry
+struct American {};
+
+struct PdeGrid {
+    int spaceSteps = 200;       // even, so the spot falls on a node
+    int timeSteps = 200;
+    double widthStdDevs = 5.0;  // half-width of the grid in units of sigma*sqrt(T)
+    int rannacherSteps = 2;
+};
+
+class CrankNicolsonSolver {
+private:
+    PdeGrid grid;
+    std::vector<double> spots, payoff, values, rhs;
+    // Precomputed forward sweeps for the implicit and Crank-Nicolson operators
+    std::vector<double> sweepImplicit, pivotImplicit, sweepCN, pivotCN;
+    std::vector<double> forward;
+
+    struct Coefficients {
+        double lower, diag, upper;
+    };
+
+    // Tridiagonal operator L V_j = lower V_{j-1} + diag V_j + upper V_{j+1}
+    static Coefficients generator(double r, double sigma, double dx) {
+        double a = 0.5 * sigma * sigma / (dx * dx);
+        double b = (r - 0.5 * sigma * sigma) / (2 * dx);
+        return {a - b, -2 * a - r, a + b};
+    }
+
+    // Factorize (I - theta dt L), eliminating towards the exercise boundary
+    void factorize(const Coefficients& L, double thetaDt, bool reversed,
+                   std::vector<double>& sweep, std::vector<double>& pivot) {
+        const int n = grid.spaceSteps;
+        double lo = -thetaDt * (reversed ? L.upper : L.lower);
+        double up = -thetaDt * (reversed ? L.lower : L.upper);
+        double d = 1 - thetaDt * L.diag;
+        double prev = 0.0;
+        for (int k = 1; k < n; ++k) {
+            pivot[k] = 1.0 / (d - lo * prev);
+            sweep[k] = up * pivot[k];
+            prev = sweep[k];
+        }
+    }
+
+    template <class Payoff, bool earlyExercise>
+    void step(const Coefficients& L, double dt, double theta, const std::vector<double>& sweep,
+              const std::vector<double>& pivot, double tau, double K, double r) {
+        const int n = grid.spaceSteps;
+        constexpr bool reversed = Payoff::phi < 0;
+
+        // Explicit part (I + (1 - theta) dt L) V
+        double w = (1 - theta) * dt;
+        for (int j = 1; j < n; ++j) {
+            rhs[j] = values[j] + w * (L.lower * values[j - 1] + L.diag * values[j] + L.upper * values[j + 1]);
+        }
+
+        // Dirichlet boundaries at the new time level
+        double discountedK = K * std::exp(-r * tau);
+        double low, high;
+        if (Payoff::phi > 0) {
+            low = 0.0;
+            high = spots[n] - discountedK;
+        } else {
+            low = discountedK - spots[0];
+            high = 0.0;
+        }
+        if (earlyExercise) {
+            low = std::max(low, payoff[0]);
+            high = std::max(high, payoff[n]);
+        }
+        rhs[1] += theta * dt * L.lower * low;
+        rhs[n - 1] += theta * dt * L.upper * high;
+        values[0] = low;
+        values[n] = high;
+
+        // Forward elimination in sweep order k = 1..n-1
+        double lo = -theta * dt * (reversed ? L.upper : L.lower);
+        double prev = 0.0;
+        for (int k = 1; k < n; ++k) {
+            int j = reversed ? n - k : k;
+            forward[k] = (rhs[j] - lo * prev) * pivot[k];
+            prev = forward[k];
+        }
+
+        // Back substitution from the exercise side, projecting onto the payoff
+        double next = 0.0;
+        for (int k = n - 1; k >= 1; --k) {
+            int j = reversed ? n - k : k;
+            double v = forward[k] - sweep[k] * next;
+            if (earlyExercise) v = std::max(v, payoff[j]);
+            values[j] = v;
+            next = v;
+        }
+    }
+
+    // Runs the full backward induction; leaves V(tau = T) in values and
+    // returns V(tau = T - dt) at the spot node for theta
+    template <class Payoff, class Exercise>
+    double solveGrid(double S, double K, double T, double r, double sigma, double gridVol) {
+        constexpr bool earlyExercise = std::is_same<Exercise, American>::value;
+        constexpr bool reversed = Payoff::phi < 0;
+        const int n = grid.spaceSteps;
+        const int mid = n / 2;
+
+        double halfWidth = grid.widthStdDevs * gridVol * std::sqrt(T);
+        double dx = 2 * halfWidth / n;
+        double x0 = std::log(S) - halfWidth;
+        for (int j = 0; j <= n; ++j) {
+            spots[j] = std::exp(x0 + j * dx);
+            payoff[j] = Payoff::intrinsic(spots[j], K);
+            values[j] = payoff[j];
+        }
+
+        Coefficients L = generator(r, sigma, dx);
+        double dt = T / grid.timeSteps;
+        factorize(L, dt, reversed, sweepImplicit, pivotImplicit);
+        factorize(L, 0.5 * dt, reversed, sweepCN, pivotCN);
+
+        double previous = values[mid];
+        for (int i = 1; i <= grid.timeSteps; ++i) {
+            previous = values[mid];
+            if (i <= grid.rannacherSteps) {
+                step<Payoff, earlyExercise>(L, dt, 1.0, sweepImplicit, pivotImplicit, i * dt, K, r);
+            } else {
+                step<Payoff, earlyExercise>(L, dt, 0.5, sweepCN, pivotCN, i * dt, K, r);
+            }
+        }
+        return previous;
+    }
+
+public:
+    explicit CrankNicolsonSolver(const PdeGrid& g = PdeGrid()) : grid(g) {
+        grid.spaceSteps += grid.spaceSteps % 2;
+        const size_t size = grid.spaceSteps + 1;
+        for (auto* v : {&spots, &payoff, &values, &rhs, &sweepImplicit, &pivotImplicit,
+                        &sweepCN, &pivotCN, &forward}) {
+            v->assign(size, 0.0);
+        }
+    }
+
+    const PdeGrid& settings() const { return grid; }
+
+    template <class Payoff, class Exercise>
+    double price(double S, double K, double T, double r, double sigma) {
+        solveGrid<Payoff, Exercise>(S, K, T, r, sigma, sigma);
+        return values[grid.spaceSteps / 2];
+    }
+
+    // Price, delta, gamma and theta come off the grid; vega and rho are
+    // re-solved on the same grid with bumped parameters
+    template <class Payoff, class Exercise>
+    Greeks greeks(double S, double K, double T, double r, double sigma) {
+        const int mid = grid.spaceSteps / 2;
+        double previous = solveGrid<Payoff, Exercise>(S, K, T, r, sigma, sigma);
+
+        double dx = std::log(spots[mid + 1] / spots[mid]);
+        double vDown = values[mid - 1], v = values[mid], vUp = values[mid + 1];
+        double dVdx = (vUp - vDown) / (2 * dx);
+        double d2Vdx2 = (vUp - 2 * v + vDown) / (dx * dx);
+
+        Greeks g;
+        g.price = v;
+        g.delta = dVdx / S;
+        g.gamma = (d2Vdx2 - dVdx) / (S * S);
+        g.theta = (previous - v) / (T / grid.timeSteps);
+
+        const double hSigma = 0.01, hRate = 1e-4;
+        solveGrid<Payoff, Exercise>(S, K, T, r, sigma + hSigma, sigma);
+        g.vega = (values[mid] - v) / hSigma;
+        solveGrid<Payoff, Exercise>(S, K, T, r + hRate, sigma, sigma);
+        g.rho = (values[mid] - v) / hRate;
+        return g;
+    }
+};
+
+// American vanilla priced on a per-thread reusable PDE workspace
+template <class Payoff>
+struct VanillaOption<Payoff, American> {
+    double spot, strike, expiry, rate, volatility;
+
+    constexpr VanillaOption(double S, double K, double T, double r, double sigma)
+        : spot(S), strike(K), expiry(T), rate(r), volatility(sigma) {}
+
+    constexpr double intrinsicValue() const { return Payoff::intrinsic(spot, strike); }
+
+    Greeks greeks(CrankNicolsonSolver& solver) const {
+        return solver.greeks<Payoff, American>(spot, strike, expiry, rate, volatility);
+    }
+
+    Greeks greeks() const {
+        thread_local CrankNicolsonSolver solver;
+        return greeks(solver);
+    }
+
+    double price(CrankNicolsonSolver& solver) const {
+        return solver.price<Payoff, American>(spot, strike, expiry, rate, volatility);
+    }
+
+    double price() const {
+        thread_local CrankNicolsonSolver solver;
+        return price(solver);
+    }
+};
+
+using AmericanCall = OptionAdapter<VanillaOption<Call, American>>;
+using AmericanPut = OptionAdapter<VanillaOption<Put, American>>;
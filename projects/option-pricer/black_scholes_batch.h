@@ -0,0 +1,74 @@
+// Batched Black-Scholes pricing over structure-of-arrays inputs
+// Prices whole books of European calls in one pass through the
+// VanillaOption<Call, European> formula, with log/exp/normCdf running on the
+// SIMD kernels in common/simd.h.
+
+#pragma once
+
+#include "../../common/simd.h"
+#include "vanilla_option.h"
+
+#include <cstddef>
+#include <vector>
+
+// Contract terms stored column-wise so each field streams contiguously
+struct EuropeanCallBatch {
+    std::vector<double> spot, strike, expiry, rate, volatility;
+
+    void add(double S, double K, double T, double r, double sigma) {
+        spot.push_back(S);
+        strike.push_back(K);
+        expiry.push_back(T);
+        rate.push_back(r);
+        volatility.push_back(sigma);
+    }
+
+    void reserve(size_t n) {
+        spot.reserve(n);
+        strike.reserve(n);
+        expiry.reserve(n);
+        rate.reserve(n);
+        volatility.reserve(n);
+    }
+
+    size_t size() const { return spot.size(); }
+};
+
+struct BatchGreeks {
+    std::vector<double> price, delta, gamma;
+
+    void resize(size_t n) {
+        price.resize(n);
+        delta.resize(n);
+        gamma.resize(n);
+    }
+};
+
+namespace detail {
+
+template <class V>
+inline void priceCallBlock(const EuropeanCallBatch& in, BatchGreeks& out, size_t i) {
+    auto g = VanillaOption<Call, European>::evaluate<V>(V::load(&in.spot[i]), V::load(&in.strike[i]),
+                                                        V::load(&in.expiry[i]), V::load(&in.rate[i]),
+                                                        V::load(&in.volatility[i]));
+    g.price.store(&out.price[i]);
+    g.delta.store(&out.delta[i]);
+    g.gamma.store(&out.gamma[i]);
+}
+
+} // namespace detail
+
+// Price, delta and gamma for every contract; out is resized to match
+inline void priceBatch(const EuropeanCallBatch& in, BatchGreeks& out) {
+    using V = simd::Native;
+    const size_t n = in.size();
+    out.resize(n);
+
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        detail::priceCallBlock<V>(in, out, i);
+    }
+    for (; i < n; ++i) {
+        detail::priceCallBlock<simd::Scalar>(in, out, i);
+    }
+}
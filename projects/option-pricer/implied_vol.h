@@ -0,0 +1,131 @@
+// Batched implied-volatility solver for European call quotes
+// Corrado-Miller initial guess followed by Halley steps using Black-Scholes
+// vega and volga, converging to a fixed tolerance in vol. Lanes are masked,
+// so a whole SIMD block keeps iterating in lock-step until every quote in it
+// has converged or run out of iterations.
+
+#pragma once
+
+#include "../../common/simd.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+enum class ImpliedVolStatus : uint8_t {
+    Converged,
+    MaxIterations,
+    OutOfBounds   // quote violates no-arbitrage bounds, no vol exists
+};
+
+// Market quotes for one chain, column-wise
+struct CallQuoteBatch {
+    std::vector<double> price, spot, strike, expiry, rate;
+
+    void add(double C, double S, double K, double T, double r) {
+        price.push_back(C);
+        spot.push_back(S);
+        strike.push_back(K);
+        expiry.push_back(T);
+        rate.push_back(r);
+    }
+
+    size_t size() const { return price.size(); }
+};
+
+struct ImpliedVolResult {
+    std::vector<double> volatility;
+    std::vector<ImpliedVolStatus> status;
+    std::vector<uint8_t> iterations;
+};
+
+struct ImpliedVolSettings {
+    double volTolerance = 1e-10;
+    int maxIterations = 20;
+    double minVol = 1e-4;
+    double maxVol = 5.0;
+};
+
+namespace detail {
+
+template <class V>
+inline void solveImpliedVolBlock(const CallQuoteBatch& in, ImpliedVolResult& out,
+                                 const ImpliedVolSettings& settings, size_t i) {
+    V C = V::load(&in.price[i]);
+    V S = V::load(&in.spot[i]);
+    V K = V::load(&in.strike[i]);
+    V T = V::load(&in.expiry[i]);
+    V r = V::load(&in.rate[i]);
+
+    V X = K * simd::exp(-r * T);
+    V sqrtT = simd::sqrt(T);
+    V logMoneyness = simd::log(S / X);
+
+    // Call prices must lie in (max(S - X, 0), S)
+    auto valid = (C > simd::max(S - X, V(0.0))) & (C < S);
+
+    // Corrado-Miller (1996) rational approximation
+    V half = C - V(0.5) * (S - X);
+    V disc = simd::max(half * half - (S - X) * (S - X) * V(1.0 / M_PI), V(0.0));
+    V sigma = V(2.5066282746310002) / (sqrtT * (S + X)) * (half + simd::sqrt(disc));
+    sigma = simd::min(simd::max(sigma, V(settings.minVol)), V(settings.maxVol));
+
+    auto active = valid;
+    V iterations = V(0.0);
+    for (int it = 0; it < settings.maxIterations && simd::any(active); ++it) {
+        V volSqrtT = sigma * sqrtT;
+        V d1 = logMoneyness / volSqrtT + V(0.5) * volSqrtT;
+        V d2 = d1 - volSqrtT;
+        V diff = S * simd::normCdf(d1) - X * simd::normCdf(d2) - C;
+        V vega = S * simd::normPdf(d1) * sqrtT;
+        V volga = vega * d1 * d2 / sigma;
+
+        // Converged once the Newton correction drops below the vol tolerance
+        V newton = diff / vega;
+        auto done = simd::abs(newton) <= V(settings.volTolerance);
+        active = active & !done;
+
+        // Halley step, falling back to Newton when the correction is unstable
+        V denom = V(1.0) - V(0.5) * newton * volga / vega;
+        V step = select(denom > V(0.5), newton / denom, newton);
+        V next = simd::min(simd::max(sigma - step, V(settings.minVol)), V(settings.maxVol));
+        sigma = select(active, next, sigma);
+        iterations = select(active, iterations + V(1.0), iterations);
+    }
+
+    sigma = select(valid, sigma, V(std::numeric_limits<double>::quiet_NaN()));
+    sigma.store(&out.volatility[i]);
+    for (int lane = 0; lane < V::width; ++lane) {
+        int n = static_cast<int>(iterations.lane(lane));
+        out.iterations[i + lane] = static_cast<uint8_t>(n);
+        if (std::isnan(sigma.lane(lane))) {
+            out.status[i + lane] = ImpliedVolStatus::OutOfBounds;
+        } else if (n >= settings.maxIterations) {
+            out.status[i + lane] = ImpliedVolStatus::MaxIterations;
+        } else {
+            out.status[i + lane] = ImpliedVolStatus::Converged;
+        }
+    }
+}
+
+} // namespace detail
+
+// Invert every quote in the chain; out is resized to match
+inline void solveImpliedVol(const CallQuoteBatch& in, ImpliedVolResult& out,
+                            const ImpliedVolSettings& settings = ImpliedVolSettings()) {
+    using V = simd::Native;
+    const size_t n = in.size();
+    out.volatility.resize(n);
+    out.status.resize(n);
+    out.iterations.resize(n);
+
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        detail::solveImpliedVolBlock<V>(in, out, settings, i);
+    }
+    for (; i < n; ++i) {
+        detail::solveImpliedVolBlock<simd::Scalar>(in, out, settings, i);
+    }
+}
@@ -4,64 +4,248 @@
 #include <iostream>
 #include <cmath>
 #include <memory>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
 
-class Option {
-protected:
-    double strike, expiry, spot, rate, volatility;
-    
-public:
-    Option(double S, double K, double T, double r, double sigma)
-        : spot(S), strike(K), expiry(T), rate(r), volatility(sigma) {}
-    
-    virtual ~Option() = default;
-    virtual double price() const = 0;
-    virtual double delta() const = 0;
-    virtual double gamma() const = 0;
-};
-
-class EuropeanCall : public Option {
-public:
-    EuropeanCall(double S, double K, double T, double r, double sigma)
-        : Option(S, K, T, r, sigma) {}
-    
-    double price() const override {
-        double d1 = (std::log(spot/strike) + (rate + 0.5*volatility*volatility)*expiry) 
-                   / (volatility * std::sqrt(expiry));
-        double d2 = d1 - volatility * std::sqrt(expiry);
-        
-        return spot * normalCDF(d1) - strike * std::exp(-rate * expiry) * normalCDF(d2);
+#include "option.h"
+#include "black_scholes_batch.h"
+#include "implied_vol.h"
+#include "monte_carlo.h"
+#include "american_pde.h"
+
+// Contracts/sec of the per-object virtual path vs the batched SoA engine
+void benchmarkBatchPricing(size_t n) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> spot(80.0, 120.0), strike(50.0, 150.0);
+    std::uniform_real_distribution<> expiry(0.05, 2.0), vol(0.1, 0.6);
+
+    EuropeanCallBatch batch;
+    batch.reserve(n);
+    std::vector<std::unique_ptr<Option>> book;
+    book.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        double S = spot(gen), K = strike(gen), T = expiry(gen), sigma = vol(gen);
+        batch.add(S, K, T, 0.05, sigma);
+        book.push_back(std::make_unique<EuropeanCall>(S, K, T, 0.05, sigma));
     }
-    
-    double delta() const override {
-        double d1 = (std::log(spot/strike) + (rate + 0.5*volatility*volatility)*expiry) 
-                   / (volatility * std::sqrt(expiry));
-        return normalCDF(d1);
+
+    using clock = std::chrono::steady_clock;
+    std::vector<double> price(n), delta(n), gamma(n);
+    auto t0 = clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        Greeks g = book[i]->greeks();
+        price[i] = g.price;
+        delta[i] = g.delta;
+        gamma[i] = g.gamma;
     }
-    
-    double gamma() const override {
-        double d1 = (std::log(spot/strike) + (rate + 0.5*volatility*volatility)*expiry) 
-                   / (volatility * std::sqrt(expiry));
-        return normalPDF(d1) / (spot * volatility * std::sqrt(expiry));
+    auto t1 = clock::now();
+    BatchGreeks greeks;
+    priceBatch(batch, greeks);
+    auto t2 = clock::now();
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        maxError = std::max({maxError, std::abs(price[i] - greeks.price[i]),
+                             std::abs(delta[i] - greeks.delta[i]),
+                             std::abs(gamma[i] - greeks.gamma[i])});
     }
-    
-private:
-    double normalCDF(double x) const {
-        return 0.5 * (1 + std::erf(x / std::sqrt(2)));
+
+    double objectSecs = std::chrono::duration<double>(t1 - t0).count();
+    double batchSecs = std::chrono::duration<double>(t2 - t1).count();
+    std::cout << "\nBatch Pricing Benchmark (" << n << " contracts, " << simd::nativeName() << ")\n";
+    std::cout << "Per-object Option: " << n / objectSecs << " contracts/sec\n";
+    std::cout << "Batched SoA:       " << n / batchSecs << " contracts/sec\n";
+    std::cout << "Speedup: " << objectSecs / batchSecs << "x, max abs diff: " << maxError << std::endl;
+}
+
+// Quotes/sec inverting a chain priced at known vols back to implied vols
+void benchmarkImpliedVol(size_t n) {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<> strike(60.0, 140.0), expiry(0.05, 2.0), vol(0.05, 0.8);
+
+    EuropeanCallBatch batch;
+    batch.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        batch.add(100.0, strike(gen), expiry(gen), 0.03, vol(gen));
     }
-    
-    double normalPDF(double x) const {
-        return std::exp(-0.5 * x * x) / std::sqrt(2 * M_PI);
+    BatchGreeks greeks;
+    priceBatch(batch, greeks);
+
+    CallQuoteBatch quotes;
+    for (size_t i = 0; i < n; ++i) {
+        quotes.add(greeks.price[i], batch.spot[i], batch.strike[i], batch.expiry[i], batch.rate[i]);
     }
-};
+
+    ImpliedVolResult result;
+    auto t0 = std::chrono::steady_clock::now();
+    solveImpliedVol(quotes, result);
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Reprice at the solved vols; deep ITM/OTM quotes with negligible vega
+    // are ill-conditioned in vol, so accuracy is measured in price
+    EuropeanCallBatch solved = batch;
+    solved.volatility = result.volatility;
+    BatchGreeks repriced;
+    priceBatch(solved, repriced);
+
+    size_t converged = 0, outOfBounds = 0;
+    double maxError = 0.0, totalIterations = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        totalIterations += result.iterations[i];
+        if (result.status[i] == ImpliedVolStatus::OutOfBounds) {
+            ++outOfBounds;
+        } else if (result.status[i] == ImpliedVolStatus::Converged) {
+            ++converged;
+            maxError = std::max(maxError, std::abs(repriced.price[i] - greeks.price[i]));
+        }
+    }
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << "\nImplied Vol Benchmark (" << n << " quotes, " << simd::nativeName() << ")\n";
+    std::cout << "Throughput: " << n / secs << " quotes/sec\n";
+    std::cout << "Converged: " << converged << ", out of bounds: " << outOfBounds
+              << ", avg iterations: " << totalIterations / n << "\n";
+    std::cout << "Max repricing error (converged): " << maxError << std::endl;
+}
+
+// Monte Carlo prices for each payoff, then paths/sec from 1 to N threads
+void benchmarkMonteCarlo() {
+    MonteCarloSettings settings;
+    std::cout << "\nMonte Carlo Pricing (" << settings.paths << " paths, antithetic + control variate)\n";
+
+    EuropeanCall closedForm(100, 100, 1.0, 0.05, 0.2);
+    MonteCarloOption<EuropeanCallPayoff> european({100}, 100, 1.0, 0.05, 0.2, settings);
+    MonteCarloOption<AsianCallPayoff> asian({100}, 100, 1.0, 0.05, 0.2, settings);
+    MonteCarloOption<UpAndOutCallPayoff> barrier({100, 130}, 100, 1.0, 0.05, 0.2, settings);
+
+    auto e = european.estimate(), a = asian.estimate(), b = barrier.estimate();
+    std::cout << "European: " << e.price << " +/- " << e.standardError
+              << " (closed form " << closedForm.price() << ")\n";
+    std::cout << "Asian:    " << a.price << " +/- " << a.standardError << "\n";
+    std::cout << "Barrier:  " << b.price << " +/- " << b.standardError << "\n";
+    MonteCarloSettings greekSettings = settings;
+    greekSettings.paths = 50000;
+    Greeks g = MonteCarloOption<AsianCallPayoff>({100}, 100, 1.0, 0.05, 0.2, greekSettings).greeks();
+    std::cout << "Asian delta/gamma/vega: " << g.delta << " / " << g.gamma << " / " << g.vega << "\n";
+
+    std::cout << "Scaling (Asian, " << settings.steps << " steps):\n";
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts;
+    for (size_t t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        auto t0 = std::chrono::steady_clock::now();
+        auto result = priceMonteCarlo(AsianCallPayoff{100}, 100, 1.0, 0.05, 0.2, settings, pool);
+        auto t1 = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        std::cout << "  " << threads << " threads: " << settings.paths / secs << " paths/sec, price "
+                  << result.price << std::endl;
+    }
+}
+
+// Per-contract cost: virtual Option vs statically typed loop vs SIMD book
+void benchmarkStaticDispatch(size_t n) {
+    using StaticCall = VanillaOption<Call, European>;
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<> strike(60.0, 140.0), expiry(0.05, 2.0), vol(0.1, 0.6);
+
+    std::vector<std::unique_ptr<Option>> virtualBook;
+    std::vector<StaticCall> staticBook;
+    VanillaBook<StaticCall> simdBook;
+    virtualBook.reserve(n);
+    staticBook.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        StaticCall option(100.0, strike(gen), expiry(gen), 0.03, vol(gen));
+        virtualBook.push_back(std::make_unique<EuropeanCall>(option.spot, option.strike, option.expiry,
+                                                             option.rate, option.volatility));
+        staticBook.push_back(option);
+        simdBook.add(option);
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto nsPerContract = [n](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::nano>(b - a).count() / n;
+    };
+
+    GreeksColumns columns;
+    columns.resize(n);
+    double checksum = 0.0;
+    auto t0 = clock::now();
+    for (const auto& option : virtualBook) checksum += option->greeks().price;
+    auto t1 = clock::now();
+    for (const auto& option : staticBook) checksum -= option.greeks().price;
+    auto t2 = clock::now();
+    simdBook.greeks(columns);
+    auto t3 = clock::now();
+
+    std::cout << "\nStatic Dispatch Benchmark (" << n << " calls, all Greeks)\n";
+    std::cout << "Virtual Option:     " << nsPerContract(t0, t1) << " ns/contract\n";
+    std::cout << "VanillaOption loop: " << nsPerContract(t1, t2) << " ns/contract\n";
+    std::cout << "VanillaBook SIMD:   " << nsPerContract(t2, t3) << " ns/contract\n";
+    std::cout << "Checksum: " << checksum << std::endl;
+}
+
+// American puts on the PDE engine: contracts/sec per grid size, with the
+// European mode checked against the closed form
+void benchmarkAmericanPde(size_t n) {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<> strike(80.0, 120.0), expiry(0.25, 2.0), vol(0.15, 0.45);
+    std::vector<VanillaOption<Put, European>> book;
+    for (size_t i = 0; i < n; ++i) {
+        book.emplace_back(100.0, strike(gen), expiry(gen), 0.05, vol(gen));
+    }
+
+    std::cout << "\nAmerican PDE Benchmark (" << n << " puts, Crank-Nicolson + projected Thomas)\n";
+    for (int size : {50, 100, 200, 400}) {
+        PdeGrid grid;
+        grid.spaceSteps = size;
+        grid.timeSteps = size;
+        CrankNicolsonSolver solver(grid);
+
+        double maxError = 0.0;
+        for (const auto& o : book) {
+            double pde = solver.price<Put, European>(o.spot, o.strike, o.expiry, o.rate, o.volatility);
+            maxError = std::max(maxError, std::abs(pde - o.price()));
+        }
+
+        double premium = 0.0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (const auto& o : book) {
+            premium += solver.price<Put, American>(o.spot, o.strike, o.expiry, o.rate, o.volatility) - o.price();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        std::cout << "  " << size << "x" << size << ": " << n / secs << " contracts/sec, European max error "
+                  << maxError << ", avg early-exercise premium " << premium / n << std::endl;
+    }
+
+    AmericanPut put(100, 100, 1.0, 0.05, 0.2);
+    Greeks g = put.greeks();
+    std::cout << "American put (S=K=100, T=1): price " << g.price << ", delta " << g.delta
+              << ", gamma " << g.gamma << ", theta " << g.theta << std::endl;
+}
 
 int main() {
     auto call = std::make_unique<EuropeanCall>(100, 100, 1.0, 0.05, 0.2);
     
     std::cout << "European Call Option Pricing\n";
     std::cout << "============================\n";
-    std::cout << "Price: $" << call->price() << std::endl;
-    std::cout << "Delta: " << call->delta() << std::endl;
-    std::cout << "Gamma: " << call->gamma() << std::endl;
+    Greeks g = call->greeks();
+    std::cout << "Price: $" << g.price << std::endl;
+    std::cout << "Delta: " << g.delta << std::endl;
+    std::cout << "Gamma: " << g.gamma << std::endl;
+    std::cout << "Vega:  " << g.vega << std::endl;
+    std::cout << "Theta: " << g.theta << std::endl;
+    std::cout << "Rho:   " << g.rho << std::endl;
+    
+    benchmarkBatchPricing(500000);
+    benchmarkImpliedVol(200000);
+    benchmarkStaticDispatch(500000);
+    benchmarkAmericanPde(1000);
+    benchmarkMonteCarlo();
     
     return 0;
 }
\ No newline at end of file
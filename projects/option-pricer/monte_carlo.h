@@ -0,0 +1,203 @@
+// Monte Carlo pricing engine for the Option hierarchy
+// Paths are split into fixed-size chunks, each with its own Philox stream, and
+// chunk results are reduced in chunk order, so prices are bit-identical for
+// any thread count. Supports antithetic variates and a closed-form European
+// call control variate.
+
+#pragma once
+
+#include "option.h"
+#include "../../common/random.h"
+#include "../../common/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct MonteCarloSettings {
+    size_t paths = 200000;
+    int steps = 252;            // monitoring dates for path-dependent payoffs
+    uint64_t seed = 42;
+    bool antithetic = true;
+    bool controlVariate = true;
+    size_t chunkSize = 4096;    // paths per RNG stream / task
+};
+
+struct MonteCarloResult {
+    double price;
+    double standardError;
+};
+
+// Payoff functors: operator() sees the full path S[0..steps]
+struct EuropeanCallPayoff {
+    static constexpr bool pathDependent = false;
+    double strike;
+
+    double operator()(const double* path, int steps) const {
+        return std::max(path[steps] - strike, 0.0);
+    }
+};
+
+struct AsianCallPayoff {
+    static constexpr bool pathDependent = true;
+    double strike;
+
+    // Arithmetic average over the monitoring dates, excluding S[0]
+    double operator()(const double* path, int steps) const {
+        double sum = 0.0;
+        for (int i = 1; i <= steps; ++i) sum += path[i];
+        return std::max(sum / steps - strike, 0.0);
+    }
+};
+
+struct UpAndOutCallPayoff {
+    static constexpr bool pathDependent = true;
+    double strike;
+    double barrier;
+
+    double operator()(const double* path, int steps) const {
+        for (int i = 1; i <= steps; ++i) {
+            if (path[i] >= barrier) return 0.0;
+        }
+        return std::max(path[steps] - strike, 0.0);
+    }
+};
+
+namespace detail {
+
+// Running sums for the payoff y and control c, combined in chunk order
+struct MonteCarloMoments {
+    double n = 0, sumY = 0, sumC = 0, sumYY = 0, sumCC = 0, sumYC = 0;
+
+    void add(double y, double c) {
+        n += 1;
+        sumY += y;
+        sumC += c;
+        sumYY += y * y;
+        sumCC += c * c;
+        sumYC += y * c;
+    }
+
+    void merge(const MonteCarloMoments& o) {
+        n += o.n;
+        sumY += o.sumY;
+        sumC += o.sumC;
+        sumYY += o.sumYY;
+        sumCC += o.sumCC;
+        sumYC += o.sumYC;
+    }
+};
+
+} // namespace detail
+
+// Price a payoff under Black-Scholes dynamics
+template <class Payoff>
+MonteCarloResult priceMonteCarlo(const Payoff& payoff, double S, double T, double r, double sigma,
+                                 const MonteCarloSettings& settings,
+                                 ThreadPool& pool = defaultThreadPool()) {
+    const int steps = Payoff::pathDependent ? settings.steps : 1;
+    const double dt = T / steps;
+    const double drift = (r - 0.5 * sigma * sigma) * dt;
+    const double diffusion = sigma * std::sqrt(dt);
+    const double discount = std::exp(-r * T);
+
+    // Antithetic pairs count as one sample
+    const size_t pathsPerSample = settings.antithetic ? 2 : 1;
+    const size_t samples = std::max<size_t>(settings.paths / pathsPerSample, 1);
+    const size_t samplesPerChunk = std::max<size_t>(settings.chunkSize / pathsPerSample, 1);
+    const size_t chunks = (samples + samplesPerChunk - 1) / samplesPerChunk;
+
+    std::vector<detail::MonteCarloMoments> chunkMoments(chunks);
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        Philox4x32 rng(settings.seed, chunk);
+        std::vector<double> normals(steps);
+        std::vector<double> path(steps + 1);
+        detail::MonteCarloMoments moments;
+
+        const size_t first = chunk * samplesPerChunk;
+        const size_t last = std::min(first + samplesPerChunk, samples);
+        for (size_t s = first; s < last; ++s) {
+            for (int i = 0; i < steps; ++i) normals[i] = rng.normal();
+
+            double y = 0.0, c = 0.0;
+            for (size_t leg = 0; leg < pathsPerSample; ++leg) {
+                const double sign = leg == 0 ? 1.0 : -1.0;
+                path[0] = S;
+                double logS = std::log(S);
+                for (int i = 0; i < steps; ++i) {
+                    logS += drift + diffusion * sign * normals[i];
+                    path[i + 1] = std::exp(logS);
+                }
+                y += payoff(path.data(), steps);
+                c += std::max(path[steps] - payoff.strike, 0.0);
+            }
+            moments.add(discount * y / pathsPerSample, discount * c / pathsPerSample);
+        }
+        chunkMoments[chunk] = moments;
+    });
+
+    detail::MonteCarloMoments total;
+    for (const auto& m : chunkMoments) total.merge(m);
+
+    const double n = total.n;
+    const double meanY = total.sumY / n;
+    const double varY = (total.sumYY - n * meanY * meanY) / (n - 1);
+    if (!settings.controlVariate) {
+        return {meanY, std::sqrt(varY / n)};
+    }
+
+    // Optimal coefficient beta = Cov(Y, C) / Var(C) against the closed form
+    const double meanC = total.sumC / n;
+    const double varC = (total.sumCC - n * meanC * meanC) / (n - 1);
+    const double covYC = (total.sumYC - n * meanY * meanC) / (n - 1);
+    const double beta = varC > 0.0 ? covYC / varC : 0.0;
+    const double exact = EuropeanCall(S, payoff.strike, T, r, sigma).price();
+    const double varControlled = std::max(varY - 2 * beta * covYC + beta * beta * varC, 0.0);
+    return {meanY - beta * (meanC - exact), std::sqrt(varControlled / n)};
+}
+
+// Any payoff functor exposed through the Option interface. Greeks are
+// bump-and-revalue with common random numbers (same seed for every bump).
+template <class Payoff>
+class MonteCarloOption : public Option {
+private:
+    Payoff payoff;
+    MonteCarloSettings settings;
+    ThreadPool* pool;
+
+    double valueAt(double S, double T, double r, double sigma) const {
+        return priceMonteCarlo(payoff, S, T, r, sigma, settings, *pool).price;
+    }
+
+public:
+    MonteCarloOption(const Payoff& p, double S, double T, double r, double sigma,
+                     const MonteCarloSettings& mc = MonteCarloSettings(),
+                     ThreadPool& threads = defaultThreadPool())
+        : Option(S, p.strike, T, r, sigma), payoff(p), settings(mc), pool(&threads) {}
+
+    // Price with its standard error, without the bumped revaluations
+    MonteCarloResult estimate() const {
+        return priceMonteCarlo(payoff, spot, expiry, rate, volatility, settings, *pool);
+    }
+
+    Greeks greeks() const override {
+        const double hS = 0.01 * spot;
+        const double hSigma = 0.01;
+        const double hRate = 1e-4;
+        const double hT = std::min(1.0 / 365.0, 0.5 * expiry);
+
+        double base = valueAt(spot, expiry, rate, volatility);
+        double up = valueAt(spot + hS, expiry, rate, volatility);
+        double down = valueAt(spot - hS, expiry, rate, volatility);
+
+        Greeks g;
+        g.price = base;
+        g.delta = (up - down) / (2 * hS);
+        g.gamma = (up - 2 * base + down) / (hS * hS);
+        g.vega = (valueAt(spot, expiry, rate, volatility + hSigma) - base) / hSigma;
+        g.theta = (valueAt(spot, expiry - hT, rate, volatility) - base) / hT;
+        g.rho = (valueAt(spot, expiry, rate + hRate, volatility) - base) / hRate;
+        return g;
+    }
+};
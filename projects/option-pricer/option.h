@@ -0,0 +1,37 @@
+// Option interface and closed-form Black-Scholes European options
+// The virtual Option API is a thin adapter over the compile-time
+// VanillaOption family in vanilla_option.h.
+
+#pragma once
+
+#include "vanilla_option.h"
+
+class Option {
+protected:
+    double strike, expiry, spot, rate, volatility;
+    
+public:
+    Option(double S, double K, double T, double r, double sigma)
+        : strike(K), expiry(T), spot(S), rate(r), volatility(sigma) {}
+    
+    virtual ~Option() = default;
+    virtual Greeks greeks() const = 0;
+    
+    double price() const { return greeks().price; }
+    double delta() const { return greeks().delta; }
+    double gamma() const { return greeks().gamma; }
+};
+
+// Exposes a statically typed instrument through the virtual interface
+template <class Instrument>
+class OptionAdapter : public Option {
+public:
+    using Option::Option;
+    
+    Greeks greeks() const override {
+        return Instrument(spot, strike, expiry, rate, volatility).greeks();
+    }
+};
+
+using EuropeanCall = OptionAdapter<VanillaOption<Call, European>>;
+using EuropeanPut = OptionAdapter<VanillaOption<Put, European>>;
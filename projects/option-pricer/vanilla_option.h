@@ -0,0 +1,136 @@
+// Compile-time specialized vanilla options
+// Payoff and exercise style are template parameters, so pricing a book of one
+// instrument type inlines to a branch-free loop with no virtual dispatch. The
+// formulas are templates over the SIMD vector type and serve both a single
+// contract (simd::Scalar) and whole SoA books.
+
+#pragma once
+
+#include "../../common/simd.h"
+
+#include <cstddef>
+#include <vector>
+
+// All sensitivities from a single evaluation of the pricing formula
+template <class T>
+struct BasicGreeks {
+    T price;
+    T delta;
+    T gamma;
+    T vega;
+    T theta;
+    T rho;
+};
+
+using Greeks = BasicGreeks<double>;
+
+// Payoff tags; phi is the sign in the Black-Scholes put/call formulas
+struct Call {
+    static constexpr double phi = 1.0;
+    static constexpr double intrinsic(double S, double K) { return S > K ? S - K : 0.0; }
+};
+
+struct Put {
+    static constexpr double phi = -1.0;
+    static constexpr double intrinsic(double S, double K) { return K > S ? K - S : 0.0; }
+};
+
+// Exercise style tags
+struct European {};
+
+template <class Payoff, class Exercise>
+struct VanillaOption;
+
+template <class Payoff>
+struct VanillaOption<Payoff, European> {
+    double spot, strike, expiry, rate, volatility;
+
+    constexpr VanillaOption(double S, double K, double T, double r, double sigma)
+        : spot(S), strike(K), expiry(T), rate(r), volatility(sigma) {}
+
+    constexpr double intrinsicValue() const { return Payoff::intrinsic(spot, strike); }
+
+    template <class V>
+    static BasicGreeks<V> evaluate(V S, V K, V T, V r, V sigma) {
+        const V phi(Payoff::phi);
+        V sqrtT = simd::sqrt(T);
+        V volSqrtT = sigma * sqrtT;
+        V d1 = (simd::log(S / K) + (r + V(0.5) * sigma * sigma) * T) / volSqrtT;
+        V d2 = d1 - volSqrtT;
+        V discountedStrike = K * simd::exp(-r * T);
+        V nd1 = simd::normCdf(phi * d1);
+        V nd2 = simd::normCdf(phi * d2);
+        V pdf = simd::normPdf(d1);
+
+        BasicGreeks<V> g;
+        g.price = phi * (S * nd1 - discountedStrike * nd2);
+        g.delta = phi * nd1;
+        g.gamma = pdf / (S * volSqrtT);
+        g.vega = S * pdf * sqrtT;
+        g.theta = -S * pdf * sigma / (V(2.0) * sqrtT) - phi * r * discountedStrike * nd2;
+        g.rho = phi * T * discountedStrike * nd2;
+        return g;
+    }
+
+    Greeks greeks() const {
+        auto g = evaluate<simd::Scalar>(spot, strike, expiry, rate, volatility);
+        return {g.price.v, g.delta.v, g.gamma.v, g.vega.v, g.theta.v, g.rho.v};
+    }
+
+    double price() const { return greeks().price; }
+};
+
+// Output columns for a whole book
+struct GreeksColumns {
+    std::vector<double> price, delta, gamma, vega, theta, rho;
+
+    void resize(size_t n) {
+        price.resize(n);
+        delta.resize(n);
+        gamma.resize(n);
+        vega.resize(n);
+        theta.resize(n);
+        rho.resize(n);
+    }
+};
+
+// A book holding a single instrument type in contiguous SoA storage
+template <class Instrument>
+class VanillaBook {
+private:
+    std::vector<double> spot, strike, expiry, rate, volatility;
+
+    template <class V>
+    void evaluateBlock(GreeksColumns& out, size_t i) const {
+        auto g = Instrument::template evaluate<V>(V::load(&spot[i]), V::load(&strike[i]),
+                                                  V::load(&expiry[i]), V::load(&rate[i]),
+                                                  V::load(&volatility[i]));
+        g.price.store(&out.price[i]);
+        g.delta.store(&out.delta[i]);
+        g.gamma.store(&out.gamma[i]);
+        g.vega.store(&out.vega[i]);
+        g.theta.store(&out.theta[i]);
+        g.rho.store(&out.rho[i]);
+    }
+
+public:
+    void add(const Instrument& option) {
+        spot.push_back(option.spot);
+        strike.push_back(option.strike);
+        expiry.push_back(option.expiry);
+        rate.push_back(option.rate);
+        volatility.push_back(option.volatility);
+    }
+
+    size_t size() const { return spot.size(); }
+
+    void greeks(GreeksColumns& out) const {
+        using V = simd::Native;
+        const size_t n = size();
+        out.resize(n);
+
+        size_t i = 0;
+        for (; i + V::width <= n; i += V::width) evaluateBlock<V>(out, i);
+        for (; i < n; ++i) evaluateBlock<simd::Scalar>(out, i);
+    }
+};
@@ -0,0 +1,176 @@
+// Packed symmetric covariance matrix with blocked SIMD kernels
+// Only the upper triangle of 64x64 tiles is stored; each tile is contiguous
+// and cache-line aligned, so a 5,000-name matrix takes half the memory of a
+// dense one and every kernel streams whole tiles. Block rows are independent
+// and run in parallel; partial sums are reduced in block order so results do
+// not depend on the thread count.
+
+#pragma once
+
+#include "../../common/aligned.h"
+#include "../../common/simd.h"
+#include "../../common/thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class PackedSymmetricMatrix {
+public:
+    static constexpr size_t blockSize = 64;
+
+private:
+    size_t n = 0;
+    size_t blocks = 0;
+    AlignedVector<double> tiles;
+
+    // Tiles (I, J) with I <= J, stored block row by block row
+    size_t tileOffset(size_t I, size_t J) const {
+        return (I * blocks - I * (I - 1) / 2 + (J - I)) * blockSize * blockSize;
+    }
+
+    const double* tile(size_t I, size_t J) const { return &tiles[tileOffset(I, J)]; }
+    double* tile(size_t I, size_t J) { return &tiles[tileOffset(I, J)]; }
+
+    // Weights copied into a zero-padded aligned buffer
+    AlignedVector<double> padded(const double* w) const {
+        AlignedVector<double> out(blocks * blockSize, 0.0);
+        std::copy(w, w + n, out.begin());
+        return out;
+    }
+
+public:
+    explicit PackedSymmetricMatrix(size_t size = 0)
+        : n(size), blocks((size + blockSize - 1) / blockSize),
+          tiles(blocks * (blocks + 1) / 2 * blockSize * blockSize, 0.0) {}
+
+    size_t size() const { return n; }
+
+    double operator()(size_t i, size_t j) const {
+        if (i > j) std::swap(i, j);
+        return tile(i / blockSize, j / blockSize)[(i % blockSize) * blockSize + j % blockSize];
+    }
+
+    void set(size_t i, size_t j, double value) {
+        if (i > j) std::swap(i, j);
+        size_t I = i / blockSize, J = j / blockSize;
+        size_t a = i % blockSize, b = j % blockSize;
+        tile(I, J)[a * blockSize + b] = value;
+        // Diagonal tiles are stored in full so kernels never branch on a < b
+        if (I == J) tile(I, J)[b * blockSize + a] = value;
+    }
+
+    // w' * Sigma * w
+    double quadraticForm(const double* weights, ThreadPool& pool = defaultThreadPool()) const {
+        using V = simd::Native;
+        const auto w = padded(weights);
+        std::vector<double> rowSums(blocks, 0.0);
+
+        pool.parallelFor(blocks, [&](size_t I) {
+            const double* wI = &w[I * blockSize];
+            V acc(0.0);
+            for (size_t J = I; J < blocks; ++J) {
+                const double* t = tile(I, J);
+                const double* wJ = &w[J * blockSize];
+                // Off-diagonal tiles count twice by symmetry
+                V tileAcc(0.0);
+                for (size_t a = 0; a < blockSize; ++a) {
+                    const double* row = t + a * blockSize;
+                    V rowAcc(0.0);
+                    for (size_t b = 0; b < blockSize; b += V::width) {
+                        rowAcc = simd::fma(V::load(row + b), V::load(wJ + b), rowAcc);
+                    }
+                    tileAcc = simd::fma(V(wI[a]), rowAcc, tileAcc);
+                }
+                acc = simd::fma(V(J == I ? 1.0 : 2.0), tileAcc, acc);
+            }
+            rowSums[I] = simd::reduceAdd(acc);
+        });
+
+        double total = 0.0;
+        for (double s : rowSums) total += s;
+        return total;
+    }
+
+    // out = Sigma * w
+    void multiply(const double* weights, double* out, ThreadPool& pool = defaultThreadPool()) const {
+        using V = simd::Native;
+        const auto w = padded(weights);
+        AlignedVector<double> result(blocks * blockSize, 0.0);
+
+        pool.parallelFor(blocks, [&](size_t I) {
+            double* outI = &result[I * blockSize];
+            // Tiles left of the diagonal are read transposed from (J, I)
+            for (size_t J = 0; J < I; ++J) {
+                const double* t = tile(J, I);
+                const double* wJ = &w[J * blockSize];
+                for (size_t a = 0; a < blockSize; ++a) {
+                    const double* row = t + a * blockSize;
+                    V wa(wJ[a]);
+                    for (size_t b = 0; b < blockSize; b += V::width) {
+                        simd::fma(V::load(row + b), wa, V::load(outI + b)).store(outI + b);
+                    }
+                }
+            }
+            for (size_t J = I; J < blocks; ++J) {
+                const double* t = tile(I, J);
+                const double* wJ = &w[J * blockSize];
+                for (size_t a = 0; a < blockSize; ++a) {
+                    const double* row = t + a * blockSize;
+                    V rowAcc(0.0);
+                    for (size_t b = 0; b < blockSize; b += V::width) {
+                        rowAcc = simd::fma(V::load(row + b), V::load(wJ + b), rowAcc);
+                    }
+                    outI[a] += simd::reduceAdd(rowAcc);
+                }
+            }
+        });
+
+        std::copy(result.begin(), result.begin() + n, out);
+    }
+
+    // y += alpha * Sigma[:, k]
+    void axpyColumn(size_t k, double alpha, double* y) const {
+        const size_t K = k / blockSize, kk = k % blockSize;
+        for (size_t I = 0; I < blocks; ++I) {
+            const size_t base = I * blockSize;
+            const size_t rows = std::min(blockSize, n - base);
+            if (I <= K) {
+                const double* t = tile(I, K);
+                for (size_t a = 0; a < rows; ++a) y[base + a] += alpha * t[a * blockSize + kk];
+            } else {
+                const double* row = tile(K, I) + kk * blockSize;
+                for (size_t a = 0; a < rows; ++a) y[base + a] += alpha * row[a];
+            }
+        }
+    }
+};
+
+// Portfolio variance kept current under single-weight changes in O(n):
+// with g = Sigma w, changing w_k by d gives
+//   var' = var + 2 d g_k + d^2 Sigma_kk  and  g' = g + d Sigma[:, k]
+class IncrementalRisk {
+private:
+    const PackedSymmetricMatrix* covariance;
+    std::vector<double> weights;
+    std::vector<double> gradient;
+    double portfolioVariance = 0.0;
+
+public:
+    IncrementalRisk(const PackedSymmetricMatrix& cov, const std::vector<double>& w,
+                    ThreadPool& pool = defaultThreadPool())
+        : covariance(&cov), weights(w), gradient(w.size()) {
+        cov.multiply(weights.data(), gradient.data(), pool);
+        for (size_t i = 0; i < weights.size(); ++i) portfolioVariance += weights[i] * gradient[i];
+    }
+
+    void updateWeight(size_t k, double w) {
+        double d = w - weights[k];
+        portfolioVariance += 2 * d * gradient[k] + d * d * (*covariance)(k, k);
+        covariance->axpyColumn(k, d, gradient.data());
+        weights[k] = w;
+    }
+
+    double variance() const { return portfolioVariance; }
+    const std::vector<double>& currentWeights() const { return weights; }
+};
@@ -0,0 +1,298 @@
+// Mean-variance and max-Sharpe optimizer with box constraints
+// Accelerated projected gradient (FISTA with adaptive restart) on
+//   min  lambda/2 w'Sigma w - mu'w   s.t.  sum(w) = 1, lo <= w <= hi
+// Each iteration is one blocked, multithreaded Sigma*w product plus an O(n)
+// projection. The gradient phase identifies which names sit on their bounds;
+// an active-set step then solves the small equality-constrained problem on
+// the free names exactly and checks the KKT conditions. Every solve starts
+// from the previous solution, so small input changes re-converge quickly.
+
+#pragma once
+
+#include "covariance.h"
+#include "../../common/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+struct OptimizerSettings {
+    int maxIterations = 5000;
+    double tolerance = 1e-9;    // max weight change between iterations
+    int polishInterval = 10;    // gradient steps between active-set attempts
+    int activeSetPasses = 20;   // free-set updates per attempt
+    size_t maxFreeNames = 2000; // above this the dense free-block solve is skipped
+};
+
+struct OptimizationResult {
+    std::vector<double> weights;
+    double expectedReturn;
+    double volatility;
+    int iterations;
+    bool converged;
+};
+
+class MeanVarianceOptimizer {
+private:
+    const PackedSymmetricMatrix* covariance;
+    std::vector<double> mu;
+    std::vector<double> lower, upper;
+    OptimizerSettings settings;
+    ThreadPool* pool;
+
+    double sigmaNorm = 0.0;            // largest eigenvalue of Sigma
+    std::vector<double> current;       // warm start
+    std::vector<double> y, grad, next, sigmaW;
+
+    // Largest eigenvalue by power iteration, for the 1/L step size
+    void estimateSpectralNorm() {
+        const size_t n = mu.size();
+        std::vector<double> v(n, 1.0 / std::sqrt(static_cast<double>(n))), Av(n);
+        double lambda = 0.0;
+        for (int it = 0; it < 50; ++it) {
+            covariance->multiply(v.data(), Av.data(), *pool);
+            double norm = 0.0;
+            for (double a : Av) norm += a * a;
+            norm = std::sqrt(norm);
+            if (norm == 0.0) break;
+            for (size_t i = 0; i < n; ++i) v[i] = Av[i] / norm;
+            if (std::abs(norm - lambda) < 1e-6 * norm) {
+                lambda = norm;
+                break;
+            }
+            lambda = norm;
+        }
+        // Small safety margin: power iteration approaches from below
+        sigmaNorm = 1.01 * lambda;
+    }
+
+    // Euclidean projection onto {sum w = 1, lo <= w <= hi}: w = clip(v - tau)
+    // with tau found by bisection on the monotone budget function
+    void project(const std::vector<double>& v, std::vector<double>& w) const {
+        const size_t n = v.size();
+        double tauLow = std::numeric_limits<double>::max(), tauHigh = std::numeric_limits<double>::lowest();
+        for (size_t i = 0; i < n; ++i) {
+            tauLow = std::min(tauLow, v[i] - upper[i]);
+            tauHigh = std::max(tauHigh, v[i] - lower[i]);
+        }
+        for (int it = 0; it < 100; ++it) {
+            double tau = 0.5 * (tauLow + tauHigh);
+            double sum = 0.0;
+            for (size_t i = 0; i < n; ++i) sum += std::min(std::max(v[i] - tau, lower[i]), upper[i]);
+            if (sum > 1.0) tauLow = tau; else tauHigh = tau;
+            if (tauHigh - tauLow < 1e-15) break;
+        }
+        double tau = 0.5 * (tauLow + tauHigh);
+        for (size_t i = 0; i < n; ++i) w[i] = std::min(std::max(v[i] - tau, lower[i]), upper[i]);
+    }
+
+    // Active-set refinement: with bound names fixed, solve
+    //   lambda Sigma_FF w_F = mu_F - lambda Sigma_FB w_B - nu 1,  1'w_F = budget
+    // by Cholesky on the free block, clamp free names that leave their box and
+    // release bound names whose KKT multiplier has the wrong sign, then repeat.
+    // Accepts only a point that is feasible and KKT; current is untouched otherwise.
+    bool polish(double riskAversion) {
+        const size_t n = mu.size();
+        const double slack = 1e-10;
+        std::vector<double> candidate = current;
+        std::vector<signed char> state(n);   // -1 at lower, +1 at upper, 0 free
+        for (size_t i = 0; i < n; ++i) {
+            state[i] = candidate[i] <= lower[i] + slack ? -1 : candidate[i] >= upper[i] - slack ? 1 : 0;
+        }
+
+        for (int pass = 0; pass < settings.activeSetPasses; ++pass) {
+            std::vector<size_t> freeSet;
+            double budget = 1.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (state[i] == 0) {
+                    freeSet.push_back(i);
+                } else {
+                    candidate[i] = state[i] < 0 ? lower[i] : upper[i];
+                    budget -= candidate[i];
+                }
+            }
+            const size_t m = freeSet.size();
+            if (m == 0 || m > settings.maxFreeNames) return false;
+
+            // Sigma_FB w_B = (Sigma w)_F - Sigma_FF w_F
+            covariance->multiply(candidate.data(), sigmaW.data(), *pool);
+            std::vector<double> A(m * m), c(m), ones(m, 1.0);
+            for (size_t a = 0; a < m; ++a) {
+                double coupling = sigmaW[freeSet[a]];
+                for (size_t b = 0; b < m; ++b) {
+                    A[a * m + b] = (*covariance)(freeSet[a], freeSet[b]);
+                    coupling -= A[a * m + b] * candidate[freeSet[b]];
+                }
+                c[a] = mu[freeSet[a]] - riskAversion * coupling;
+            }
+
+            // In-place Cholesky of Sigma_FF, then forward/back substitution
+            for (size_t j = 0; j < m; ++j) {
+                double d = A[j * m + j];
+                for (size_t k = 0; k < j; ++k) d -= A[j * m + k] * A[j * m + k];
+                if (d <= 0.0) return false;
+                A[j * m + j] = std::sqrt(d);
+                for (size_t i = j + 1; i < m; ++i) {
+                    double v = A[i * m + j];
+                    for (size_t k = 0; k < j; ++k) v -= A[i * m + k] * A[j * m + k];
+                    A[i * m + j] = v / A[j * m + j];
+                }
+            }
+            auto solveInPlace = [&](std::vector<double>& x) {
+                for (size_t i = 0; i < m; ++i) {
+                    for (size_t k = 0; k < i; ++k) x[i] -= A[i * m + k] * x[k];
+                    x[i] /= A[i * m + i];
+                }
+                for (size_t i = m; i-- > 0;) {
+                    for (size_t k = i + 1; k < m; ++k) x[i] -= A[k * m + i] * x[k];
+                    x[i] /= A[i * m + i];
+                }
+            };
+            solveInPlace(c);
+            solveInPlace(ones);
+            double sumC = 0.0, sumOnes = 0.0;
+            for (size_t a = 0; a < m; ++a) {
+                sumC += c[a];
+                sumOnes += ones[a];
+            }
+            const double nu = (sumC - riskAversion * budget) / sumOnes;
+
+            bool feasible = true;
+            for (size_t a = 0; a < m; ++a) {
+                const size_t i = freeSet[a];
+                candidate[i] = (c[a] - nu * ones[a]) / riskAversion;
+                if (candidate[i] < lower[i] - 1e-12) { state[i] = -1; feasible = false; }
+                if (candidate[i] > upper[i] + 1e-12) { state[i] = 1; feasible = false; }
+            }
+            if (!feasible) continue;
+
+            // Bound names must not want to move into the interior
+            covariance->multiply(candidate.data(), sigmaW.data(), *pool);
+            const double tol = 1e-9 * (1.0 + std::abs(nu));
+            bool optimal = true;
+            for (size_t i = 0; i < n; ++i) {
+                double reduced = riskAversion * sigmaW[i] - mu[i] + nu;
+                if ((state[i] < 0 && reduced < -tol) || (state[i] > 0 && reduced > tol)) {
+                    state[i] = 0;
+                    optimal = false;
+                }
+            }
+            if (optimal) {
+                current.swap(candidate);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    OptimizationResult summarize(int iterations, bool converged) {
+        covariance->multiply(current.data(), sigmaW.data(), *pool);
+        double ret = 0.0, var = 0.0;
+        for (size_t i = 0; i < current.size(); ++i) {
+            ret += mu[i] * current[i];
+            var += current[i] * sigmaW[i];
+        }
+        return {current, ret, std::sqrt(std::max(var, 0.0)), iterations, converged};
+    }
+
+public:
+    MeanVarianceOptimizer(const PackedSymmetricMatrix& cov, std::vector<double> expectedReturns,
+                          const OptimizerSettings& s = OptimizerSettings(),
+                          ThreadPool& threads = defaultThreadPool())
+        : covariance(&cov), mu(std::move(expectedReturns)), lower(mu.size(), 0.0),
+          upper(mu.size(), 1.0), settings(s), pool(&threads) {
+        const size_t n = mu.size();
+        if (cov.size() != n) throw std::invalid_argument("MeanVarianceOptimizer: size mismatch");
+        current.assign(n, 1.0 / n);
+        y.resize(n);
+        grad.resize(n);
+        next.resize(n);
+        sigmaW.resize(n);
+        estimateSpectralNorm();
+    }
+
+    // Box constraints; the default is long-only with no upper limit
+    void setBounds(double lo, double hi) {
+        if (lo * mu.size() > 1.0 || hi * mu.size() < 1.0) {
+            throw std::invalid_argument("MeanVarianceOptimizer: bounds admit no fully invested portfolio");
+        }
+        std::fill(lower.begin(), lower.end(), lo);
+        std::fill(upper.begin(), upper.end(), hi);
+    }
+
+    // New expected returns keep the previous solution as the warm start
+    void updateExpectedReturns(const std::vector<double>& expectedReturns) { mu = expectedReturns; }
+
+    void resetWarmStart() { std::fill(current.begin(), current.end(), 1.0 / current.size()); }
+
+    OptimizationResult solve(double riskAversion) {
+        if (!(riskAversion > 0.0)) throw std::invalid_argument("MeanVarianceOptimizer: risk aversion must be positive");
+        const size_t n = mu.size();
+        const double step = 1.0 / (riskAversion * sigmaNorm);
+        project(current, current);   // the warm start may violate new bounds
+        y = current;
+        double t = 1.0;
+
+        for (int it = 1; it <= settings.maxIterations; ++it) {
+            covariance->multiply(y.data(), sigmaW.data(), *pool);
+            for (size_t i = 0; i < n; ++i) {
+                grad[i] = riskAversion * sigmaW[i] - mu[i];
+                next[i] = y[i] - step * grad[i];
+            }
+            project(next, next);
+
+            double change = 0.0, restart = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                change = std::max(change, std::abs(next[i] - current[i]));
+                restart += grad[i] * (next[i] - current[i]);
+            }
+
+            // Restart momentum when it points uphill (O'Donoghue & Candes)
+            double tNext = restart > 0.0 ? 1.0 : 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * t * t));
+            double momentum = restart > 0.0 ? 0.0 : (t - 1.0) / tNext;
+            for (size_t i = 0; i < n; ++i) {
+                y[i] = next[i] + momentum * (next[i] - current[i]);
+            }
+            current.swap(next);
+            t = tNext;
+
+            if (change < settings.tolerance) return summarize(it, true);
+            if (it % settings.polishInterval == 0 && polish(riskAversion)) return summarize(it, true);
+        }
+        return summarize(settings.maxIterations, false);
+    }
+
+    // Max-Sharpe portfolio along the constrained efficient frontier: golden
+    // section search over log(risk aversion), each solve warm-started
+    OptimizationResult maximizeSharpe(double riskFreeRate, double minAversion = 0.1,
+                                      double maxAversion = 1000.0) {
+        if (!(minAversion > 0.0) || !(maxAversion >= minAversion)) {
+            throw std::invalid_argument("MeanVarianceOptimizer: need 0 < minAversion <= maxAversion");
+        }
+        auto sharpe = [&](double logLambda, OptimizationResult& out) {
+            out = solve(std::exp(logLambda));
+            return (out.expectedReturn - riskFreeRate) / out.volatility;
+        };
+        const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+        double a = std::log(minAversion), b = std::log(maxAversion);
+        double c = b - ratio * (b - a), d = a + ratio * (b - a);
+        OptimizationResult rc, rd;
+        double fc = sharpe(c, rc), fd = sharpe(d, rd);
+        for (int it = 0; it < 30 && b - a > 1e-3; ++it) {
+            if (fc > fd) {
+                b = d; d = c; fd = fc; rd = rc;
+                c = b - ratio * (b - a);
+                fc = sharpe(c, rc);
+            } else {
+                a = c; c = d; fc = fd; rc = rd;
+                d = a + ratio * (b - a);
+                fd = sharpe(d, rd);
+            }
+        }
+        const OptimizationResult& best = fc > fd ? rc : rd;
+        current = best.weights;
+        return best;
+    }
+};
@@ -7,84 +7,254 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
 
-struct Asset {
-    std::string symbol;
-    double weight;
-    double expectedReturn;
-    double volatility;
-    std::vector<double> returns;
-};
-
-class Portfolio {
-private:
-    std::vector<Asset> assets;
-    std::vector<std::vector<double>> correlationMatrix;
-    
-public:
-    void addAsset(const Asset& asset) {
-        assets.push_back(asset);
-    }
-    
-    double calculateExpectedReturn() const {
-        return std::accumulate(assets.begin(), assets.end(), 0.0,
-            [](double sum, const Asset& asset) {
-                return sum + asset.weight * asset.expectedReturn;
-            });
+#include "covariance.h"
+#include "tail_risk.h"
+#include "return_store.h"
+#include "optimizer.h"
+#include "portfolio.h"
+
+// Dense scalar w'Sigma*w against the blocked kernel and O(n) weight updates
+void benchmarkCovarianceRisk(size_t n) {
+    // One-factor model: Sigma_ij = beta_i beta_j f^2 + delta_ij s_i^2
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<> beta(0.5, 1.5), idio(0.1, 0.4);
+    std::vector<double> b(n), s(n), w(n, 1.0 / n);
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = beta(gen);
+        s[i] = idio(gen);
     }
-    
-    double calculateVolatility() const {
-        double variance = 0.0;
-        
-        // Individual asset variance contribution
-        for (const auto& asset : assets) {
-            variance += asset.weight * asset.weight * asset.volatility * asset.volatility;
-        }
-        
-        // Correlation contribution (simplified - assumes correlation = 0.3)
-        for (size_t i = 0; i < assets.size(); ++i) {
-            for (size_t j = i + 1; j < assets.size(); ++j) {
-                variance += 2 * assets[i].weight * assets[j].weight * 
-                           assets[i].volatility * assets[j].volatility * 0.3;
-            }
+
+    std::vector<double> dense(n * n);
+    PackedSymmetricMatrix packed(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) {
+            double c = b[i] * b[j] * 0.04 + (i == j ? s[i] * s[i] : 0.0);
+            dense[i * n + j] = dense[j * n + i] = c;
+            packed.set(i, j, c);
         }
-        
-        return std::sqrt(variance);
     }
-    
-    double calculateSharpeRatio(double riskFreeRate = 0.02) const {
-        double excessReturn = calculateExpectedReturn() - riskFreeRate;
-        return excessReturn / calculateVolatility();
+
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    double denseVar = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) denseVar += w[i] * dense[i * n + j] * w[j];
     }
-    
-    double calculateVaR(double confidence = 0.05) const {
-        // Parametric VaR calculation
-        double portfolioReturn = calculateExpectedReturn();
-        double portfolioVol = calculateVolatility();
-        
-        // Z-score for 95% confidence (1.645)
-        double zScore = 1.645;
-        return -(portfolioReturn - zScore * portfolioVol);
+    auto t1 = clock::now();
+    double packedVar = packed.quadraticForm(w.data());
+    auto t2 = clock::now();
+
+    IncrementalRisk risk(packed, w);
+    const int updates = 1000;
+    auto t3 = clock::now();
+    for (int u = 0; u < updates; ++u) risk.updateWeight((u * 7919) % n, 2.0 / n);
+    auto t4 = clock::now();
+    double fullVar = packed.quadraticForm(risk.currentWeights().data());
+
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    std::cout << "\nCovariance Risk Benchmark (" << n << " assets, " << simd::nativeName() << ", "
+              << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Dense scalar loop: " << ms(t0, t1) << " ms\n";
+    std::cout << "Blocked packed:    " << ms(t1, t2) << " ms (diff " << std::abs(denseVar - packedVar) << ")\n";
+    std::cout << "Incremental update: " << ms(t3, t4) * 1000 / updates << " us/update (drift "
+              << std::abs(risk.variance() - fullVar) << ")" << std::endl;
+}
+
+// Scenario generation, P&L product and quantile selection at scale.
+// The overnight run is 10k assets x 100k scenarios (8 GB of scenarios);
+// pass those sizes on the command line on a machine with the memory.
+void benchmarkTailRisk(size_t assets, size_t scenarios) {
+    PackedSymmetricMatrix cov(assets);
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<> beta(0.5, 1.5), idio(0.1, 0.4);
+    std::vector<double> b(assets), s(assets);
+    for (size_t i = 0; i < assets; ++i) {
+        b[i] = beta(gen);
+        s[i] = idio(gen);
     }
-    
-    void printAnalysis() const {
-        std::cout << "Portfolio Analysis\n";
-        std::cout << "==================\n";
-        std::cout << "Expected Return: " << calculateExpectedReturn() * 100 << "%\n";
-        std::cout << "Volatility: " << calculateVolatility() * 100 << "%\n";
-        std::cout << "Sharpe Ratio: " << calculateSharpeRatio() << "\n";
-        std::cout << "VaR (95%): " << calculateVaR() * 100 << "%\n";
+    for (size_t i = 0; i < assets; ++i) {
+        for (size_t j = i; j < assets; ++j) cov.set(i, j, b[i] * b[j] * 0.04 + (i == j ? s[i] * s[i] : 0.0));
+    }
+    std::vector<double> w(assets, 1.0 / assets), mean(assets, 0.0);
+
+    using clock = std::chrono::steady_clock;
+    auto secs = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double>(b - a).count();
+    };
+    auto t0 = clock::now();
+    CholeskyFactor factor(cov);
+    auto t1 = clock::now();
+    ScenarioMatrix R = generateScenarios(factor, mean, scenarios, 7, std::sqrt(1.0 / 252));
+    auto t2 = clock::now();
+    std::vector<double> pnl;
+    portfolioPnL(R, w.data(), pnl);
+    auto t3 = clock::now();
+    std::vector<double> sorted = pnl;
+    TailRisk risk = tailRisk(pnl, 0.01);
+    auto t4 = clock::now();
+    std::sort(sorted.begin(), sorted.end());
+    auto t5 = clock::now();
+
+    double gigabytes = 8.0 * assets * scenarios / 1e9;
+    std::cout << "\nTail Risk Benchmark (" << assets << " assets x " << scenarios << " scenarios, "
+              << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Cholesky:      " << secs(t0, t1) << " s\n";
+    std::cout << "Scenarios:     " << scenarios / secs(t1, t2) << " scenarios/sec\n";
+    std::cout << "P&L R*w:       " << secs(t2, t3) * 1000 << " ms (" << gigabytes / secs(t2, t3) << " GB/s)\n";
+    std::cout << "nth_element:   " << secs(t3, t4) * 1000 << " ms vs full sort " << secs(t4, t5) * 1000 << " ms\n";
+    std::cout << "99% VaR / ES:  " << risk.valueAtRisk * 100 << "% / " << risk.expectedShortfall * 100 << "%" << std::endl;
+}
+
+// Startup cost of the mapped store vs parsing the same history from CSV.
+// The production universe is 8k assets x 10 years; the CSV leg is the
+// expensive part, so the default here is smaller.
+void benchmarkReturnStore(size_t assetCount, size_t days) {
+    const std::string csvPath = "/tmp/qf_returns.csv", storePath = "/tmp/qf_returns.qfr";
+    std::vector<int32_t> dates(days);
+    std::vector<std::string> symbols(assetCount);
+    std::vector<std::vector<double>> columns(assetCount, std::vector<double>(days));
+    Philox4x32 rng(9);
+    for (size_t d = 0; d < days; ++d) {
+        // Business days encoded as yyyymmdd, 21 per month
+        dates[d] = static_cast<int32_t>(20150000 + (d / 252) * 10000 + (d % 252) / 21 * 100 + 100 + d % 21 + 1);
+    }
+    for (size_t i = 0; i < assetCount; ++i) {
+        symbols[i] = "SYM" + std::to_string(i);
+        for (size_t d = 0; d < days; ++d) columns[i][d] = 0.015 * rng.normal();
+    }
+    {
+        std::ofstream csv(csvPath);
+        csv << "date";
+        for (const auto& sym : symbols) csv << ',' << sym;
+        csv << '\n';
+        for (size_t d = 0; d < days; ++d) {
+            csv << dates[d];
+            for (size_t i = 0; i < assetCount; ++i) csv << ',' << columns[i][d];
+            csv << '\n';
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    auto t0 = clock::now();
+    convertCsvToReturnStore(csvPath, storePath);
+    auto t1 = clock::now();
+    auto store = std::make_shared<const ReturnStore>(storePath);
+    auto t2 = clock::now();
+
+    Portfolio book;
+    for (size_t i = 0; i < assetCount; ++i) book.addAsset({symbols[i], 1.0 / assetCount, 0.08, 0.2, {}});
+    book.attachReturnHistory(store);
+    auto t3 = clock::now();
+    TailRisk lastYear = book.calculateHistoricalVaR(0.01, dates[days - 252], dates[days - 1]);
+    auto t4 = clock::now();
+
+    std::cout << "\nReturn Store Benchmark (" << assetCount << " assets x " << days << " days)\n";
+    std::cout << "CSV -> store conversion: " << ms(t0, t1) << " ms\n";
+    std::cout << "Open mapped store:       " << ms(t1, t2) << " ms\n";
+    std::cout << "1y historical 99% VaR:   " << lastYear.valueAtRisk * 100 << "% in " << ms(t3, t4) << " ms" << std::endl;
+    std::remove(csvPath.c_str());
+    std::remove(storePath.c_str());
+}
+
+// Cold and warm-started solves on a one-factor universe with a 2% name cap
+void benchmarkOptimizer(size_t n) {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<> beta(0.5, 1.5), idio(0.15, 0.45), alpha(0.02, 0.15);
+    std::vector<double> b(n), s(n), mu(n);
+    for (size_t i = 0; i < n; ++i) {
+        b[i] = beta(gen);
+        s[i] = idio(gen);
+        mu[i] = alpha(gen);
+    }
+    PackedSymmetricMatrix cov(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) cov.set(i, j, b[i] * b[j] * 0.04 + (i == j ? s[i] * s[i] : 0.0));
     }
-};
 
-int main() {
+    using clock = std::chrono::steady_clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    auto t0 = clock::now();
+    MeanVarianceOptimizer optimizer(cov, mu);
+    optimizer.setBounds(0.0, 0.02);
+    OptimizationResult cold = optimizer.solve(5.0);
+    auto t1 = clock::now();
+
+    // Intraday update: expected returns move by ~1%
+    std::normal_distribution<> noise(0.0, 0.01);
+    for (auto& m : mu) m *= 1.0 + noise(gen);
+    optimizer.updateExpectedReturns(mu);
+    auto t2 = clock::now();
+    OptimizationResult warm = optimizer.solve(5.0);
+    auto t3 = clock::now();
+    OptimizationResult sharpe = optimizer.maximizeSharpe(0.02);
+    auto t4 = clock::now();
+
+    size_t held = std::count_if(warm.weights.begin(), warm.weights.end(), [](double w) { return w > 1e-6; });
+    std::cout << "\nMean-Variance Optimizer Benchmark (" << n << " assets, 0-2% box, "
+              << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Cold solve: " << ms(t0, t1) << " ms (" << cold.iterations << " iterations)\n";
+    std::cout << "Warm solve: " << ms(t2, t3) << " ms (" << warm.iterations << " iterations, "
+              << held << " names held)\n";
+    std::cout << "Max Sharpe: " << ms(t3, t4) << " ms, Sharpe "
+              << (sharpe.expectedReturn - 0.02) / sharpe.volatility << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::string(argv[1]) == "--convert") {
+        convertCsvToReturnStore(argv[2], argv[3]);
+        std::cout << "Wrote " << argv[3] << std::endl;
+        return 0;
+    }
+    
     Portfolio portfolio;
     
-    portfolio.addAsset({"AAPL", 0.4, 0.12, 0.25, {}});
-    portfolio.addAsset({"GOOGL", 0.3, 0.15, 0.30, {}});
-    portfolio.addAsset({"BONDS", 0.3, 0.04, 0.05, {}});
+    // Two years of daily returns drawn from the same correlation model
+    std::vector<std::vector<double>> correlation = {{1.0, 0.6, -0.2},
+                                                    {0.6, 1.0, -0.1},
+                                                    {-0.2, -0.1, 1.0}};
+    std::vector<Asset> universe = {{"AAPL", 0.4, 0.12, 0.25, {}},
+                                   {"GOOGL", 0.3, 0.15, 0.30, {}},
+                                   {"BONDS", 0.3, 0.04, 0.05, {}}};
+    Philox4x32 rng(2024);
+    for (int day = 0; day < 504; ++day) {
+        double z0 = rng.normal(), z1 = rng.normal(), z2 = rng.normal();
+        double e[3] = {z0, 0.6 * z0 + 0.8 * z1, -0.2 * z0 + 0.025 * z1 + 0.9797 * z2};
+        for (int i = 0; i < 3; ++i) {
+            universe[i].returns.push_back(universe[i].expectedReturn / 252 +
+                                          universe[i].volatility / std::sqrt(252.0) * e[i]);
+        }
+    }
+    for (const auto& asset : universe) portfolio.addAsset(asset);
+    portfolio.setCorrelationMatrix(correlation);
     
     portfolio.printAnalysis();
     
+    OptimizationResult best = portfolio.optimizeMaxSharpe(0.02);
+    std::cout << "\nMax-Sharpe weights:";
+    for (double w : best.weights) std::cout << " " << w;
+    std::cout << " (Sharpe " << portfolio.calculateSharpeRatio() << ")\n";
+    
+    benchmarkCovarianceRisk(5000);
+    size_t benchAssets = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t benchScenarios = argc > 2 ? std::stoul(argv[2]) : 20000;
+    benchmarkTailRisk(benchAssets, benchScenarios);
+    benchmarkReturnStore(2000, 2520);
+    benchmarkOptimizer(3000);
+    
     return 0;
 }
\ No newline at end of file
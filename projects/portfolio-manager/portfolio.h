@@ -0,0 +1,250 @@
+// Portfolio of assets with parametric, historical and Monte Carlo risk
+// Weights, expected returns and volatilities live per asset; the covariance
+// comes from the volatilities and a correlation matrix (or is set directly)
+// and is rebuilt only after a change. Single-weight changes update the risk
+// incrementally, and mean-variance optimization warm-starts across calls.
+
+#pragma once
+
+#include "covariance.h"
+#include "optimizer.h"
+#include "return_store.h"
+#include "tail_risk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Asset {
+    std::string symbol;
+    double weight;
+    double expectedReturn;
+    double volatility;
+    std::vector<double> returns;
+};
+
+class Portfolio {
+private:
+    std::vector<Asset> assets;
+    std::vector<std::vector<double>> correlationMatrix;
+    
+    // Covariance built from asset vols and correlationMatrix on first use
+    mutable PackedSymmetricMatrix covariance;
+    mutable bool covarianceStale = true;
+    bool covarianceSetDirectly = false;
+    std::unique_ptr<IncrementalRisk> incremental;
+    std::shared_ptr<const ReturnStore> returnHistory;
+    std::unique_ptr<MeanVarianceOptimizer> optimizer;
+    
+    const PackedSymmetricMatrix& covarianceMatrix() const {
+        if (covarianceStale) {
+            size_t n = assets.size();
+            if (!correlationMatrix.empty() &&
+                (correlationMatrix.size() != n ||
+                 std::any_of(correlationMatrix.begin(), correlationMatrix.end(),
+                             [n](const std::vector<double>& row) { return row.size() != n; }))) {
+                throw std::invalid_argument("Portfolio: correlation matrix is not assets x assets");
+            }
+            covariance = PackedSymmetricMatrix(n);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = i; j < n; ++j) {
+                    // Assets are uncorrelated unless a correlation matrix is given
+                    double rho = correlationMatrix.empty() ? (i == j ? 1.0 : 0.0) : correlationMatrix[i][j];
+                    covariance.set(i, j, rho * assets[i].volatility * assets[j].volatility);
+                }
+            }
+            covarianceStale = false;
+        }
+        return covariance;
+    }
+    
+    OptimizationResult applyOptimized(double riskAversion, double minWeight, double maxWeight,
+                                      bool maxSharpe, double riskFreeRate) {
+        std::vector<double> mu(assets.size());
+        for (size_t i = 0; i < assets.size(); ++i) mu[i] = assets[i].expectedReturn;
+        if (!optimizer) {
+            optimizer = std::make_unique<MeanVarianceOptimizer>(covarianceMatrix(), mu);
+        } else {
+            optimizer->updateExpectedReturns(mu);
+        }
+        optimizer->setBounds(minWeight, maxWeight);
+        
+        OptimizationResult result = maxSharpe ? optimizer->maximizeSharpe(riskFreeRate)
+                                              : optimizer->solve(riskAversion);
+        for (size_t i = 0; i < assets.size(); ++i) assets[i].weight = result.weights[i];
+        incremental.reset();
+        return result;
+    }
+    
+    std::vector<double> weights() const {
+        std::vector<double> w(assets.size());
+        for (size_t i = 0; i < assets.size(); ++i) w[i] = assets[i].weight;
+        return w;
+    }
+    
+public:
+    void addAsset(const Asset& asset) {
+        if (covarianceSetDirectly) {
+            throw std::invalid_argument("Portfolio: cannot add an asset to a directly set covariance");
+        }
+        assets.push_back(asset);
+        covarianceStale = true;
+        incremental.reset();
+        optimizer.reset();
+    }
+    
+    void setCorrelationMatrix(const std::vector<std::vector<double>>& correlation) {
+        correlationMatrix = correlation;
+        covarianceStale = true;
+        covarianceSetDirectly = false;
+        incremental.reset();
+        optimizer.reset();
+    }
+    
+    // Use a prebuilt covariance directly, e.g. for large universes; it must
+    // cover the current assets, and the asset list is then fixed
+    void setCovarianceMatrix(PackedSymmetricMatrix cov) {
+        if (cov.size() != assets.size()) {
+            throw std::invalid_argument("Portfolio: covariance size does not match the asset count");
+        }
+        covariance = std::move(cov);
+        covarianceStale = false;
+        covarianceSetDirectly = true;
+        incremental.reset();
+        optimizer.reset();
+    }
+    
+    // Read return history from a mapped store instead of Asset::returns
+    void attachReturnHistory(std::shared_ptr<const ReturnStore> store) {
+        returnHistory = std::move(store);
+    }
+    
+    // Change one weight and update the risk in O(n) instead of O(n^2)
+    void updateWeight(size_t index, double weight) {
+        if (!incremental) {
+            incremental = std::make_unique<IncrementalRisk>(covarianceMatrix(), weights());
+        }
+        incremental->updateWeight(index, weight);
+        assets[index].weight = weight;
+    }
+    
+    // Choose weights on the constrained efficient frontier; successive calls
+    // warm-start from the previous solution
+    OptimizationResult optimizeMeanVariance(double riskAversion, double minWeight = 0.0, double maxWeight = 1.0) {
+        return applyOptimized(riskAversion, minWeight, maxWeight, false, 0.0);
+    }
+    
+    OptimizationResult optimizeMaxSharpe(double riskFreeRate = 0.02, double minWeight = 0.0, double maxWeight = 1.0) {
+        return applyOptimized(0.0, minWeight, maxWeight, true, riskFreeRate);
+    }
+    
+    double calculateExpectedReturn() const {
+        return std::accumulate(assets.begin(), assets.end(), 0.0,
+            [](double sum, const Asset& asset) {
+                return sum + asset.weight * asset.expectedReturn;
+            });
+    }
+    
+    double calculateVolatility() const {
+        if (incremental) {
+            return std::sqrt(std::max(incremental->variance(), 0.0));
+        }
+        auto w = weights();
+        return std::sqrt(covarianceMatrix().quadraticForm(w.data()));
+    }
+    
+    double calculateSharpeRatio(double riskFreeRate = 0.02) const {
+        double excessReturn = calculateExpectedReturn() - riskFreeRate;
+        return excessReturn / calculateVolatility();
+    }
+    
+    double calculateVaR(double confidence = 0.05) const {
+        // Parametric VaR calculation
+        double portfolioReturn = calculateExpectedReturn();
+        double portfolioVol = calculateVolatility();
+        
+        // Z-score for the tail probability (1.645 at 5%)
+        double zScore = -inverseNormalCdf(confidence);
+        return -(portfolioReturn - zScore * portfolioVol);
+    }
+    
+    // Historical simulation over the attached store, restricted to a date
+    // window (yyyymmdd); columns are read in place
+    TailRisk calculateHistoricalVaR(double confidence, int32_t fromDate, int32_t toDate) const {
+        if (!returnHistory) throw std::logic_error("calculateHistoricalVaR: no return history attached");
+        std::vector<std::string> symbols;
+        for (const auto& asset : assets) symbols.push_back(asset.symbol);
+        ReturnWindow window = returnHistory->window(symbols, fromDate, toDate);
+        
+        std::vector<double> pnl;
+        auto w = weights();
+        portfolioPnL(window, w.data(), pnl);
+        return tailRisk(pnl, confidence);
+    }
+    
+    // Historical simulation over the stored return series (equal lengths)
+    TailRisk calculateHistoricalVaR(double confidence = 0.05) const {
+        if (returnHistory) {
+            return calculateHistoricalVaR(confidence, std::numeric_limits<int32_t>::min(),
+                                          std::numeric_limits<int32_t>::max());
+        }
+        if (assets.empty()) throw std::invalid_argument("calculateHistoricalVaR: empty portfolio");
+        size_t history = assets[0].returns.size();
+        ScenarioMatrix scenarios(history, assets.size());
+        for (size_t j = 0; j < assets.size(); ++j) {
+            if (assets[j].returns.size() != history) {
+                throw std::invalid_argument("calculateHistoricalVaR: return series differ in length");
+            }
+            std::copy(assets[j].returns.begin(), assets[j].returns.end(), scenarios.column(j));
+        }
+        
+        std::vector<double> pnl;
+        auto w = weights();
+        portfolioPnL(scenarios, w.data(), pnl);
+        return tailRisk(pnl, confidence);
+    }
+    
+    // Monte Carlo over the covariance model, horizon in years (1/252 = one day)
+    TailRisk calculateMonteCarloVaR(double confidence = 0.05, size_t scenarioCount = 100000,
+                                    double horizon = 1.0 / 252, uint64_t seed = 42) const {
+        CholeskyFactor factor(covarianceMatrix());
+        std::vector<double> mean(assets.size());
+        for (size_t i = 0; i < assets.size(); ++i) mean[i] = assets[i].expectedReturn * horizon;
+        
+        ScenarioMatrix scenarios = generateScenarios(factor, mean, scenarioCount, seed, std::sqrt(horizon));
+        std::vector<double> pnl;
+        auto w = weights();
+        portfolioPnL(scenarios, w.data(), pnl);
+        return tailRisk(pnl, confidence);
+    }
+    
+    void printAnalysis() const {
+        std::cout << "Portfolio Analysis\n";
+        std::cout << "==================\n";
+        std::cout << "Expected Return: " << calculateExpectedReturn() * 100 << "%\n";
+        std::cout << "Volatility: " << calculateVolatility() * 100 << "%\n";
+        std::cout << "Sharpe Ratio: " << calculateSharpeRatio() << "\n";
+        std::cout << "VaR (95%): " << calculateVaR() * 100 << "%\n";
+        
+        bool hasHistory = returnHistory || (!assets.empty() && !assets[0].returns.empty());
+        for (double confidence : {0.05, 0.01}) {
+            int level = static_cast<int>(std::round((1 - confidence) * 100));
+            if (hasHistory) {
+                TailRisk h = calculateHistoricalVaR(confidence);
+                std::cout << "Historical 1d VaR/ES (" << level << "%): " << h.valueAtRisk * 100 << "% / "
+                          << h.expectedShortfall * 100 << "%\n";
+            }
+            TailRisk mc = calculateMonteCarloVaR(confidence);
+            std::cout << "Monte Carlo 1d VaR/ES (" << level << "%): " << mc.valueAtRisk * 100 << "% / "
+                      << mc.expectedShortfall * 100 << "%\n";
+        }
+    }
+};
@@ -0,0 +1,288 @@
+// Memory-mapped columnar store for asset return histories
+// File layout (little-endian, every section 64-byte aligned):
+//   header | dates (int32 yyyymmdd, ascending) | symbol offsets (uint64, n+1)
+//   | symbol characters | columns (double, one contiguous column per asset)
+// The file is mapped read-only and columns are read in place, so opening an
+// 8k-asset, 10-year history costs a header read and a symbol index, not
+// millions of allocations. Date-range windows are pointer views.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct ReturnStoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t assetCount;
+    uint64_t dateCount;
+    uint64_t columnStride;        // doubles between consecutive columns
+    uint64_t datesOffset;
+    uint64_t symbolOffsetsOffset;
+    uint64_t symbolDataOffset;
+    uint64_t columnsOffset;
+};
+
+constexpr char returnStoreMagic[8] = {'Q', 'F', 'R', 'E', 'T', 'S', '0', '1'};
+
+// Zero-copy view of a date window over a set of columns
+class ReturnWindow {
+private:
+    std::vector<const double*> columns;
+    size_t length = 0;
+
+public:
+    ReturnWindow() = default;
+    ReturnWindow(std::vector<const double*> cols, size_t len) : columns(std::move(cols)), length(len) {}
+
+    size_t scenarios() const { return length; }
+    size_t assets() const { return columns.size(); }
+    const double* column(size_t asset) const { return columns[asset]; }
+};
+
+class ReturnStore {
+private:
+    void* mapping = nullptr;
+    size_t mappedBytes = 0;
+    const ReturnStoreHeader* header = nullptr;
+    const int32_t* dateIndex = nullptr;
+    const double* columnData = nullptr;
+    std::vector<std::string> symbolNames;
+    std::unordered_map<std::string, size_t> symbolIndex;
+
+    // count elements of size bytes at offset lie inside the mapping, aligned
+    bool holds(uint64_t offset, uint64_t count, uint64_t size) const {
+        return offset <= mappedBytes && offset % size == 0 && count <= (mappedBytes - offset) / size;
+    }
+
+    // Every section and symbol offset in bounds, without overflow
+    bool validLayout() const {
+        const char* base = static_cast<const char*>(mapping);
+        const ReturnStoreHeader& h = *header;
+        if (std::memcmp(h.magic, returnStoreMagic, sizeof returnStoreMagic) != 0 || h.version != 1 ||
+            h.assetCount >= mappedBytes || h.columnStride < h.dateCount ||
+            !holds(h.datesOffset, h.dateCount, sizeof(int32_t)) ||
+            !holds(h.symbolOffsetsOffset, h.assetCount + 1, sizeof(uint64_t)) ||
+            !holds(h.symbolDataOffset, 0, 1) || !holds(h.columnsOffset, 0, sizeof(double))) {
+            return false;
+        }
+        const uint64_t columnCapacity = (mappedBytes - h.columnsOffset) / sizeof(double);
+        if (h.columnStride != 0 && h.assetCount > columnCapacity / h.columnStride) return false;
+
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + h.symbolOffsetsOffset);
+        if (offsets[h.assetCount] > mappedBytes - h.symbolDataOffset) return false;
+        for (size_t i = 0; i < h.assetCount; ++i) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return true;
+    }
+
+public:
+    explicit ReturnStore(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("ReturnStore: cannot open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ReturnStoreHeader))) {
+            ::close(fd);
+            throw std::runtime_error("ReturnStore: not a return store: " + path);
+        }
+        mappedBytes = static_cast<size_t>(info.st_size);
+        mapping = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::runtime_error("ReturnStore: mmap failed for " + path);
+        }
+
+        const char* base = static_cast<const char*>(mapping);
+        header = reinterpret_cast<const ReturnStoreHeader*>(base);
+        if (!validLayout()) {
+            ::munmap(mapping, mappedBytes);
+            throw std::runtime_error("ReturnStore: corrupt or unsupported file " + path);
+        }
+        dateIndex = reinterpret_cast<const int32_t*>(base + header->datesOffset);
+        columnData = reinterpret_cast<const double*>(base + header->columnsOffset);
+
+        // Symbol dictionary is the only part copied out of the mapping
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + header->symbolOffsetsOffset);
+        const char* chars = base + header->symbolDataOffset;
+        symbolNames.reserve(header->assetCount);
+        symbolIndex.reserve(header->assetCount);
+        for (size_t i = 0; i < header->assetCount; ++i) {
+            symbolNames.emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+            symbolIndex.emplace(symbolNames.back(), i);
+        }
+    }
+
+    ~ReturnStore() {
+        if (mapping) ::munmap(mapping, mappedBytes);
+    }
+
+    ReturnStore(const ReturnStore&) = delete;
+    ReturnStore& operator=(const ReturnStore&) = delete;
+
+    size_t assets() const { return header->assetCount; }
+    size_t dates() const { return header->dateCount; }
+    int32_t date(size_t i) const { return dateIndex[i]; }
+    const std::string& symbol(size_t i) const { return symbolNames[i]; }
+
+    // Column index for a symbol, or npos when absent
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    size_t find(const std::string& sym) const {
+        auto it = symbolIndex.find(sym);
+        return it == symbolIndex.end() ? npos : it->second;
+    }
+
+    const double* column(size_t asset) const { return columnData + asset * header->columnStride; }
+
+    // Half-open index range [first, last) of dates within [fromDate, toDate]
+    std::pair<size_t, size_t> dateRange(int32_t fromDate, int32_t toDate) const {
+        const int32_t* begin = dateIndex;
+        const int32_t* end = dateIndex + dates();
+        size_t first = std::lower_bound(begin, end, fromDate) - begin;
+        size_t last = std::upper_bound(begin, end, toDate) - begin;
+        return {first, std::max(first, last)};
+    }
+
+    ReturnWindow window(const std::vector<std::string>& symbols, int32_t fromDate, int32_t toDate) const {
+        auto range = dateRange(fromDate, toDate);
+        std::vector<const double*> cols;
+        cols.reserve(symbols.size());
+        for (const auto& sym : symbols) {
+            size_t idx = find(sym);
+            if (idx == npos) throw std::out_of_range("ReturnStore: unknown symbol " + sym);
+            cols.push_back(column(idx) + range.first);
+        }
+        return ReturnWindow(std::move(cols), range.second - range.first);
+    }
+};
+
+// Write a store from in-memory columns (columns[asset][date])
+inline void writeReturnStore(const std::string& path, const std::vector<int32_t>& dates,
+                             const std::vector<std::string>& symbols,
+                             const std::vector<std::vector<double>>& columns) {
+    auto align = [](uint64_t offset) { return (offset + 63) / 64 * 64; };
+    const uint64_t n = symbols.size(), T = dates.size();
+
+    ReturnStoreHeader h{};
+    std::memcpy(h.magic, returnStoreMagic, sizeof h.magic);
+    h.version = 1;
+    h.assetCount = n;
+    h.dateCount = T;
+    h.columnStride = (T + 7) / 8 * 8;
+    h.datesOffset = align(sizeof h);
+    h.symbolOffsetsOffset = align(h.datesOffset + T * sizeof(int32_t));
+    std::vector<uint64_t> offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) offsets[i + 1] = offsets[i] + symbols[i].size();
+    h.symbolDataOffset = align(h.symbolOffsetsOffset + (n + 1) * sizeof(uint64_t));
+    h.columnsOffset = align(h.symbolDataOffset + offsets[n]);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("writeReturnStore: cannot create " + path);
+    auto padTo = [&out](uint64_t offset) {
+        static const char zeros[64] = {};
+        uint64_t pos = static_cast<uint64_t>(out.tellp());
+        if (offset > pos) out.write(zeros, offset - pos);
+    };
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    padTo(h.datesOffset);
+    out.write(reinterpret_cast<const char*>(dates.data()), T * sizeof(int32_t));
+    padTo(h.symbolOffsetsOffset);
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    padTo(h.symbolDataOffset);
+    for (const auto& sym : symbols) out.write(sym.data(), sym.size());
+    padTo(h.columnsOffset);
+
+    std::vector<double> padding(h.columnStride - T, 0.0);
+    for (const auto& col : columns) {
+        if (col.size() != T) throw std::invalid_argument("writeReturnStore: column length mismatch");
+        out.write(reinterpret_cast<const char*>(col.data()), T * sizeof(double));
+        out.write(reinterpret_cast<const char*>(padding.data()), padding.size() * sizeof(double));
+    }
+    if (!out) throw std::runtime_error("writeReturnStore: write failed for " + path);
+}
+
+// Convert a wide CSV (header "date,SYM1,SYM2,...", one row per date with
+// yyyymmdd or yyyy-mm-dd dates) into a return store. Every cell must hold a
+// finite number: readers take the columns as complete, so a missing or
+// malformed cell is an error naming its line and symbol, not a NaN.
+inline void convertCsvToReturnStore(const std::string& csvPath, const std::string& storePath) {
+    std::ifstream in(csvPath);
+    if (!in) throw std::runtime_error("convertCsvToReturnStore: cannot open " + csvPath);
+
+    std::string line, cell;
+    // Tolerate CRLF line endings
+    auto readLine = [&in, &line]() {
+        if (!std::getline(in, line)) return false;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    };
+    if (!readLine()) throw std::runtime_error("convertCsvToReturnStore: empty file");
+    std::vector<std::string> symbols;
+    {
+        std::stringstream header(line);
+        std::getline(header, cell, ',');   // date column
+        while (std::getline(header, cell, ',')) symbols.push_back(cell);
+    }
+
+    std::vector<int32_t> dates;
+    std::vector<std::vector<double>> columns(symbols.size());
+    size_t lineNumber = 1;
+    while (readLine()) {
+        ++lineNumber;
+        if (line.empty()) continue;
+        const char* p = line.c_str();
+        const char* end = p + line.size();
+        auto fail = [&](const std::string& what) {
+            throw std::runtime_error("convertCsvToReturnStore: line " + std::to_string(lineNumber) + ": " + what);
+        };
+
+        int32_t date = 0;
+        int digits = 0;
+        for (; p < end && *p != ','; ++p) {
+            if (*p >= '0' && *p <= '9') {
+                date = date * 10 + (*p - '0');
+                ++digits;
+            } else if (*p != '-') {
+                fail("malformed date");
+            }
+        }
+        if (digits != 8) fail("malformed date");
+        dates.push_back(date);
+
+        for (size_t j = 0; j < symbols.size(); ++j) {
+            if (p == end) fail("missing cell for " + symbols[j]);
+            ++p;   // skip ','
+            char* next;
+            const double value = std::strtod(p, &next);
+            if (next == p || (next != end && *next != ',') || !std::isfinite(value)) {
+                fail("malformed or empty cell for " + symbols[j]);
+            }
+            p = next;
+            columns[j].push_back(value);
+        }
+        if (p != end) fail("more cells than symbols");
+    }
+
+    if (!std::is_sorted(dates.begin(), dates.end())) {
+        throw std::runtime_error("convertCsvToReturnStore: dates must be ascending");
+    }
+    writeReturnStore(storePath, dates, symbols, columns);
+}
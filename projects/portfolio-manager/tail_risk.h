@@ -0,0 +1,177 @@
+// Historical and Monte Carlo VaR / Expected Shortfall
+// Scenarios live in a column-major scenario x asset matrix, so the portfolio
+// P&L is one matrix-vector product made of contiguous axpys per asset. The
+// loss quantile comes from nth_element rather than a full sort. Monte Carlo
+// scenarios are correlated through a Cholesky factor and generated in
+// parallel, one Philox stream per scenario block: the normals are drawn in
+// bulk and correlated by a blocked GEMM against the factor.
+
+#pragma once
+
+#include "covariance.h"
+#include "../../common/aligned.h"
+#include "../../common/gemm.h"
+#include "../../common/random.h"
+#include "../../common/simd.h"
+#include "../../common/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+struct TailRisk {
+    double valueAtRisk;        // loss at the (1 - alpha) quantile, positive = loss
+    double expectedShortfall;  // mean loss beyond the VaR
+};
+
+class ScenarioMatrix {
+private:
+    size_t scenarioCount = 0;
+    size_t assetCount = 0;
+    size_t stride = 0;     // column length, padded to a whole SIMD block
+    AlignedVector<double> data;
+
+public:
+    ScenarioMatrix() = default;
+    ScenarioMatrix(size_t scenarios, size_t assets)
+        : scenarioCount(scenarios), assetCount(assets), stride((scenarios + 7) / 8 * 8),
+          data(stride * assets, 0.0) {}
+
+    size_t scenarios() const { return scenarioCount; }
+    size_t assets() const { return assetCount; }
+    size_t columnStride() const { return stride; }
+
+    double* column(size_t asset) { return &data[asset * stride]; }
+    const double* column(size_t asset) const { return &data[asset * stride]; }
+};
+
+// Scenarios handled per task in the P&L product and in MC generation (the
+// latter holds a block of normals for every asset, so it is smaller)
+constexpr size_t scenarioBlock = 1024;
+constexpr size_t generationBlock = 256;
+
+// pnl = R * w, parallel over scenario blocks so each slice of pnl stays in cache.
+// Columns is any column source with scenarios(), assets() and column(j),
+// e.g. ScenarioMatrix or a mapped ReturnWindow.
+template <class Columns>
+void portfolioPnL(const Columns& R, const double* weights, std::vector<double>& pnl,
+                  ThreadPool& pool = defaultThreadPool()) {
+    using V = simd::Native;
+    const size_t S = R.scenarios();
+    pnl.assign(S, 0.0);
+    const size_t blocks = (S + scenarioBlock - 1) / scenarioBlock;
+
+    pool.parallelFor(blocks, [&](size_t block) {
+        const size_t first = block * scenarioBlock;
+        const size_t last = std::min(first + scenarioBlock, S);
+        double* out = &pnl[first];
+        for (size_t j = 0; j < R.assets(); ++j) {
+            const double* col = R.column(j) + first;
+            const V w(weights[j]);
+            size_t s = 0;
+            for (; s + V::width <= last - first; s += V::width) {
+                simd::fma(V::load(col + s), w, V::load(out + s)).store(out + s);
+            }
+            for (; s < last - first; ++s) out[s] += weights[j] * col[s];
+        }
+    });
+}
+
+// VaR/ES at tail probability alpha; reorders pnl in place
+inline TailRisk tailRisk(std::vector<double>& pnl, double alpha) {
+    if (pnl.empty()) throw std::invalid_argument("tailRisk: no scenarios");
+    const size_t tail = std::max<size_t>(1, static_cast<size_t>(std::ceil(alpha * pnl.size())));
+    auto cutoff = pnl.begin() + (tail - 1);
+    std::nth_element(pnl.begin(), cutoff, pnl.end());
+
+    double tailSum = 0.0;
+    for (auto it = pnl.begin(); it <= cutoff; ++it) tailSum += *it;
+    return {-*cutoff, -tailSum / tail};
+}
+
+// Dense lower-triangular Cholesky factor, row-major
+class CholeskyFactor {
+private:
+    size_t n = 0;
+    AlignedVector<double> L;
+
+    static double dot(const double* a, const double* b, size_t len) {
+        using V = simd::Native;
+        V acc(0.0);
+        size_t k = 0;
+        for (; k + V::width <= len; k += V::width) acc = simd::fma(V::load(a + k), V::load(b + k), acc);
+        double sum = simd::reduceAdd(acc);
+        for (; k < len; ++k) sum += a[k] * b[k];
+        return sum;
+    }
+
+public:
+    // Left-looking factorization: once column j is known, every row below it
+    // is independent, so each column is split across the pool
+    CholeskyFactor(const PackedSymmetricMatrix& cov, ThreadPool& pool = defaultThreadPool())
+        : n(cov.size()), L(n * n, 0.0) {
+        for (size_t j = 0; j < n; ++j) {
+            double* Lj = &L[j * n];
+            double pivot = cov(j, j) - dot(Lj, Lj, j);
+            if (pivot <= 0.0) throw std::runtime_error("CholeskyFactor: matrix not positive definite");
+            Lj[j] = std::sqrt(pivot);
+            const double inv = 1.0 / Lj[j];
+
+            const size_t rows = n - j - 1;
+            const size_t chunk = 64;
+            pool.parallelFor((rows + chunk - 1) / chunk, [&](size_t c) {
+                const size_t first = j + 1 + c * chunk;
+                const size_t last = std::min(first + chunk, n);
+                for (size_t i = first; i < last; ++i) {
+                    double* Li = &L[i * n];
+                    Li[j] = (cov(i, j) - dot(Li, Lj, j)) * inv;
+                }
+            });
+        }
+    }
+
+    size_t size() const { return n; }
+    const double* row(size_t i) const { return &L[i * n]; }
+};
+
+// Rows of L per GEMM in scenario generation; each band multiplies only up to
+// its last row's diagonal, so the triangle's zeros cost at most one band
+constexpr size_t generationBand = 64;
+
+// Correlated scenarios R = mean + scale * Z L' with Z iid standard normal.
+// Column-major R is the row-major asset x scenario matrix R', so each block
+// is R' = mean + L (scale Z') with Z' laid out the same way.
+inline ScenarioMatrix generateScenarios(const CholeskyFactor& factor, const std::vector<double>& mean,
+                                        size_t scenarios, uint64_t seed, double scale = 1.0,
+                                        ThreadPool& pool = defaultThreadPool()) {
+    using V = simd::Native;
+    const size_t n = factor.size();
+    ScenarioMatrix R(scenarios, n);
+    const size_t blocks = (scenarios + generationBlock - 1) / generationBlock;
+
+    pool.parallelFor(blocks, [&](size_t block) {
+        const size_t first = block * generationBlock;
+        const size_t count = std::min(generationBlock, scenarios - first);
+
+        // Independent normals for this block, one row of count per asset
+        Philox4x32 rng(seed, block);
+        AlignedVector<double> Z(count * n);
+        rng.fillNormal(Z.data(), Z.size());
+        if (scale != 1.0) {
+            const V sv(scale);
+            size_t k = 0;
+            for (; k + V::width <= Z.size(); k += V::width) (V::load(&Z[k]) * sv).store(&Z[k]);
+            for (; k < Z.size(); ++k) Z[k] *= scale;
+        }
+
+        for (size_t i = 0; i < n; ++i) std::fill(R.column(i) + first, R.column(i) + first + count, mean[i]);
+        for (size_t i0 = 0; i0 < n; i0 += generationBand) {
+            const size_t i1 = std::min(n, i0 + generationBand);
+            gemm::multiply(i1 - i0, count, i1, factor.row(i0), n, Z.data(), count, R.column(i0) + first,
+                           R.columnStride(), 1.0);
+        }
+    });
+    return R;
+}
@@ -3,160 +3,210 @@
 
 #include <iostream>
 #include <vector>
-#include <random>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <string>
 
-class NeuralNetwork {
-private:
-    std::vector<std::vector<std::vector<double>>> weights;
-    std::vector<std::vector<double>> biases;
-    
-public:
-    NeuralNetwork(const std::vector<int>& layers) {
-        for (int i = 0; i < layers.size() - 1; ++i) {
-            weights.push_back(std::vector<std::vector<double>>(
-                layers[i], std::vector<double>(layers[i+1])));
-            biases.push_back(std::vector<double>(layers[i+1]));
-            
-            // Random initialization
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::normal_distribution<> normal(0.0, 0.1);
-            
-            for (auto& row : weights.back()) {
-                for (auto& w : row) {
-                    w = normal(gen);
-                }
-            }
-            for (auto& b : biases.back()) {
-                b = normal(gen);
-            }
+#include "deep_hedging.h"
+#include "deep_hedging_agent.h"
+#include "hedge_inference.h"
+#include "neural_network.h"
+
+// Batched forward/backward against per-sample calls, plus a finite-difference
+// check of the backward pass on L = sum(output^2) / 2
+void benchmarkNetwork(size_t batch, int repetitions) {
+    NeuralNetwork network({5, 32, 32, 1});
+    NetworkWorkspace ws(network, batch);
+    Philox4x32 rng(5);
+    std::vector<double> inputs(batch * 5);
+    for (double& x : inputs) x = rng.normal();
+    std::vector<double> gradient(network.parameterCount(), 0.0), outputGrad(batch);
+
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point a, clock::time_point b) { return std::chrono::duration<double>(b - a).count(); };
+
+    auto t0 = clock::now();
+    double perSampleSum = 0.0, batchedSum = 0.0;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        for (size_t i = 0; i < batch; ++i) {
+            std::vector<double> x(inputs.begin() + 5 * i, inputs.begin() + 5 * i + 5);
+            perSampleSum += network.forward(x)[0];
         }
     }
-    
-    std::vector<double> forward(const std::vector<double>& input) {
-        std::vector<double> current = input;
-        
-        for (int layer = 0; layer < weights.size(); ++layer) {
-            std::vector<double> next(weights[layer][0].size(), 0.0);
-            
-            for (int j = 0; j < next.size(); ++j) {
-                for (int i = 0; i < current.size(); ++i) {
-                    next[j] += current[i] * weights[layer][i][j];
-                }
-                next[j] += biases[layer][j];
-                
-                // ReLU activation (except last layer)
-                if (layer < weights.size() - 1) {
-                    next[j] = std::max(0.0, next[j]);
-                }
-            }
-            current = next;
-        }
-        
-        return current;
+    auto t1 = clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        const double* out = network.forward(inputs.data(), batch, ws);
+        for (size_t i = 0; i < batch; ++i) batchedSum += out[i];
     }
+    auto t2 = clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        const double* out = network.forward(inputs.data(), batch, ws);
+        std::copy(out, out + batch, outputGrad.begin());
+        network.backward(outputGrad.data(), ws, gradient.data());
+    }
+    auto t3 = clock::now();
+
+    // Finite differences on a few parameters, small batch
+    const size_t small = 7;
+    NetworkWorkspace smallWs(network, small);
+    auto loss = [&]() {
+        const double* out = network.forward(inputs.data(), small, smallWs);
+        double sum = 0.0;
+        for (size_t i = 0; i < small; ++i) sum += 0.5 * out[i] * out[i];
+        return sum;
+    };
+    std::vector<double> exact(network.parameterCount(), 0.0);
+    const double* out = network.forward(inputs.data(), small, smallWs);
+    std::vector<double> smallGrad(out, out + small);
+    network.backward(smallGrad.data(), smallWs, exact.data());
+    double worst = 0.0;
+    for (size_t p = 0; p < network.parameterCount(); p += 97) {
+        double saved = network.parameters()[p];
+        network.parameters()[p] = saved + 1e-6;
+        double up = loss();
+        network.parameters()[p] = saved - 1e-6;
+        double down = loss();
+        network.parameters()[p] = saved;
+        worst = std::max(worst, std::abs((up - down) / 2e-6 - exact[p]) / std::max(1.0, std::abs(exact[p])));
+    }
+
+    const double samples = double(batch) * repetitions;
+    std::cout << "\nNeural Network Benchmark (5-32-32-1, batch " << batch << ", " << simd::nativeName() << ")\n";
+    std::cout << "Per-sample forward: " << 1e9 * seconds(t0, t1) / samples << " ns/sample\n";
+    std::cout << "Batched forward:    " << 1e9 * seconds(t1, t2) / samples << " ns/sample ("
+              << seconds(t0, t1) / seconds(t1, t2) << "x)\n";
+    std::cout << "Forward + backward: " << 1e9 * seconds(t2, t3) / samples << " ns/sample\n";
+    std::cout << "Per-sample vs batched output sum difference: " << std::abs(perSampleSum - batchedSum) << "\n";
+    std::cout << "Gradient check: max relative error " << worst << "\n";
+}
+
+struct HedgeState {
+    double S, tau, vol, previous, wealth;
 };
 
-class DeepHedgingAgent {
-private:
-    NeuralNetwork network;
-    double transaction_cost;
-    
-public:
-    DeepHedgingAgent(double tc = 0.001) 
-        : network({5, 32, 32, 1}), transaction_cost(tc) {}
+void printLatency(const char* name, std::vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    auto at = [&](double q) { return ns[std::min(ns.size() - 1, static_cast<size_t>(q * ns.size()))]; };
+    std::cout << name << "p50 " << at(0.5) << " ns, p90 " << at(0.9) << " ns, p99 " << at(0.99)
+              << " ns, p99.9 " << at(0.999) << " ns\n";
+}
+
+// Per-call latency of the allocating double-precision hedge against frozen
+// float32 and int8 networks over varied market states (timer overhead shown
+// separately), plus their largest deviation from the double hedge
+void benchmarkInference(DeepHedgingAgent& agent, size_t calls) {
+    const auto f32 = agent.freeze<InferencePrecision::Float32>();
+    const auto i8 = agent.freeze<InferencePrecision::Int8>();
+    Philox4x32 rng(17);
+    std::vector<HedgeState> states(4096);
+    for (HedgeState& s : states) {
+        s = {100.0 * (0.8 + 0.4 * rng.uniform()), rng.uniform(), 0.16 + 0.08 * rng.uniform(),
+             2.0 * rng.uniform() - 1.0, 10.0 * rng.normal()};
+    }
     
-    // Get hedging position based on market state
-    double getHedgeRatio(double S, double t, double vol, double delta_prev, double pnl) {
-        std::vector<double> features = {S/100.0, t, vol, delta_prev, pnl/1000.0};
-        auto output = network.forward(features);
-        return std::tanh(output[0]); // Bounded between -1 and 1
+    double errorF32 = 0.0, errorI8 = 0.0;
+    for (const HedgeState& s : states) {
+        double exact = agent.getHedgeRatio(s.S, s.tau, s.vol, s.previous, s.wealth);
+        errorF32 = std::max(errorF32, std::abs(hedgeRatio(f32, s.S, s.tau, s.vol, s.previous, s.wealth) - exact));
+        errorI8 = std::max(errorI8, std::abs(hedgeRatio(i8, s.S, s.tau, s.vol, s.previous, s.wealth) - exact));
     }
     
-    // Simulate hedging strategy
-    double simulateHedging(double S0, double K, double T, double vol, double r = 0.05) {
-        int n_steps = 50;
-        double dt = T / n_steps;
-        
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::normal_distribution<> normal(0.0, 1.0);
-        
-        double S = S0;
-        double delta = 0.0;
-        double cash = 0.0;
-        double pnl = 0.0;
-        
-        for (int i = 0; i < n_steps; ++i) {
-            double t = i * dt;
-            
-            // Get new hedge ratio from neural network
-            double new_delta = getHedgeRatio(S, t/T, vol, delta, pnl);
-            
-            // Transaction cost
-            double trade_amount = new_delta - delta;
-            cash -= trade_amount * S + transaction_cost * std::abs(trade_amount) * S;
-            delta = new_delta;
-            
-            // Update P&L
-            pnl = delta * S + cash;
-            
-            // Evolve stock price
-            double dW = normal(gen) * std::sqrt(dt);
-            S *= std::exp((r - 0.5 * vol * vol) * dt + vol * dW);
+    using clock = std::chrono::steady_clock;
+    std::vector<double> ns(calls);
+    volatile double sink = 0.0;
+    auto measure = [&](const char* name, auto&& hedge) {
+        for (size_t c = 0; c < calls; ++c) {
+            const HedgeState& s = states[c % states.size()];
+            auto t0 = clock::now();
+            sink = hedge(s);
+            auto t1 = clock::now();
+            ns[c] = std::chrono::duration<double, std::nano>(t1 - t0).count();
         }
-        
-        // Final P&L including option payoff
-        double option_payoff = std::max(S - K, 0.0);
-        double final_pnl = delta * S + cash - option_payoff;
-        
-        return final_pnl;
-    }
+        printLatency(name, ns);
+    };
     
-    // Train the network (simplified version)
-    void train(int episodes = 1000) {
-        std::cout << "Training Deep Hedging Agent...\n";
-        
-        double total_loss = 0.0;
-        for (int ep = 0; ep < episodes; ++ep) {
-            // Random market parameters
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<> uniform(0.8, 1.2);
-            
-            double S0 = 100.0 * uniform(gen);
-            double K = 100.0;
-            double vol = 0.2 * uniform(gen);
-            
-            double pnl = simulateHedging(S0, K, 0.25, vol);
-            total_loss += pnl * pnl; // Minimize variance of P&L
-            
-            if (ep % 100 == 0) {
-                std::cout << "Episode " << ep << ", Avg Loss: " << total_loss / (ep + 1) << std::endl;
-            }
+    std::cout << "\nHedge Inference Latency (" << calls << " calls, " << simd::nativeName() << ")\n";
+    measure("Timer overhead:     ", [](const HedgeState& s) { return s.previous; });
+    measure("Double, allocating: ", [&](const HedgeState& s) {
+        return agent.getHedgeRatio(s.S, s.tau, s.vol, s.previous, s.wealth);
+    });
+    measure("Frozen float32:     ", [&](const HedgeState& s) {
+        return hedgeRatio(f32, s.S, s.tau, s.vol, s.previous, s.wealth);
+    });
+    measure("Frozen int8:        ", [&](const HedgeState& s) {
+        return hedgeRatio(i8, s.S, s.tau, s.vol, s.previous, s.wealth);
+    });
+    std::cout << "Max |hedge - double hedge|: float32 " << errorF32 << ", int8 " << errorI8 << "\n";
+}
+
+// Error of the mean P&L on 2^14 paths, over several seeds, for Philox paths
+// and for Sobol points through the bridge; the reference is a 2^20-path
+// Sobol run, whose own error is well below either
+void comparePathSampling(const DeepHedgingAgent& agent, int seeds = 8) {
+    const size_t paths = 1 << 14;
+    std::vector<double> large =
+        agent.simulateHedging(100.0, 100.0, 0.25, 0.2, 0.05, 1 << 20, 1, PathSampling::SobolBridge);
+    const double reference = std::accumulate(large.begin(), large.end(), 0.0) / large.size();
+    std::cout << "\nMean P&L error on " << paths << " paths against " << reference << " (RMS over " << seeds
+              << " seeds):\n";
+    for (PathSampling sampling : {PathSampling::PseudoRandom, PathSampling::SobolBridge}) {
+        double squared = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int seed = 0; seed < seeds; ++seed) {
+            std::vector<double> pnls = agent.simulateHedging(100.0, 100.0, 0.25, 0.2, 0.05, paths, 100 + seed, sampling);
+            double mean = std::accumulate(pnls.begin(), pnls.end(), 0.0) / paths;
+            squared += (mean - reference) * (mean - reference);
         }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("  %-14s %.5f  (%.0f paths/s)\n",
+                    sampling == PathSampling::PseudoRandom ? "Philox" : "Sobol + bridge", std::sqrt(squared / seeds),
+                    seeds * paths / seconds);
     }
-};
+}
 
-int main() {
+// Optional arguments: objective (mse, cvar or entropic), minibatches,
+// checkpoint path for the trained weights
+int main(int argc, char** argv) {
     std::cout << "Deep Hedging Implementation (Buehler et al. 2019)\n";
     std::cout << "================================================\n";
     
     DeepHedgingAgent agent(0.001); // 0.1% transaction cost
     
     // Train the agent
-    agent.train(500);
+    TrainingSettings settings;
+    settings.batchPaths = 2048;
+    settings.minibatches = argc > 2 ? std::stoul(argv[2]) : 100;
+    settings.learningRate = 5e-3;
+    std::string objective = argc > 1 ? argv[1] : "mse";
+    if (objective == "cvar") settings.objective = HedgeObjective::CVaR;
+    else if (objective == "entropic") settings.objective = HedgeObjective::Entropic;
+    else if (objective != "mse") {
+        std::cerr << "Unknown objective " << objective << " (mse, cvar or entropic)\n";
+        return 1;
+    }
+    settings.reportInterval = settings.minibatches / 10;
+    
+    TrainingReport report = agent.train(settings);
+    std::cout << "Trained on " << report.episodes << " episodes in " << report.seconds << " s ("
+              << report.episodesPerSecond() << " episodes/s, " << defaultThreadPool().size() << " threads)\n";
+    if (argc > 3) {
+        agent.saveCheckpoint(argv[3]);
+        agent.loadCheckpoint(argv[3]);
+        std::cout << "Checkpoint written to " << argv[3] << "\n";
+    }
     
     // Test hedging performance
     std::cout << "\nTesting hedging performance:\n";
     
-    std::vector<double> pnls;
-    for (int i = 0; i < 100; ++i) {
-        double pnl = agent.simulateHedging(100.0, 100.0, 0.25, 0.2);
-        pnls.push_back(pnl);
-    }
+    const size_t testPaths = 1000000;
+    auto testStart = std::chrono::steady_clock::now();
+    std::vector<double> pnls = agent.simulateHedging(100.0, 100.0, 0.25, 0.2, 0.05, testPaths);
+    double testSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - testStart).count();
+    std::cout << "Simulated " << testPaths << " paths in " << testSeconds << " s (" << testPaths / testSeconds
+              << " paths/s)\n";
     
     double mean_pnl = 0.0, var_pnl = 0.0;
     for (double pnl : pnls) {
@@ -173,5 +223,9 @@ int main() {
     std::cout << "P&L Variance: " << var_pnl << std::endl;
     std::cout << "P&L Std Dev: " << std::sqrt(var_pnl) << std::endl;
     
+    comparePathSampling(agent);
+    benchmarkNetwork(256, 800);
+    benchmarkInference(agent, 200000);
+
     return 0;
 }
\ No newline at end of file
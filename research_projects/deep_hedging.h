@@ -0,0 +1,478 @@
+// Deep hedging of a European call under GBM with proportional costs
+// At each step the hedge is tanh(network(features)) with features
+// (S / 100, t / T, vol, previous hedge, wealth / 1000), as in DeepHedgingAgent.
+// HedgingSimulator evaluates a network on many paths: chunks of paths keep
+// structure-of-arrays state, draw bulk SIMD normals and make one batched
+// network call per step, and chunks are spread over the thread pool. Paths
+// come from Philox normals or from Sobol points through a Brownian bridge.
+// HedgingTrainer simulates a minibatch of paths in lock-step: each shard of
+// paths keeps time-major state arrays and makes one batched network call per
+// step. Gradients of the objective come from a reverse sweep through the
+// steps that recomputes each step's activations instead of storing all of
+// them. Shards run on the thread pool with their own Philox stream and
+// gradient buffer, and the buffers are summed in shard order, so a trained
+// network does not depend on the thread count.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/quasi_random.h"
+#include "../common/random.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+#include "neural_network.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+constexpr size_t hedgeFeatureCount = 5;
+constexpr double hedgeSpotScale = 100.0;
+constexpr double hedgeWealthScale = 1000.0;
+
+inline void hedgeFeatures(double* x, double S, double tau, double vol, double previousHedge, double wealth) {
+    x[0] = S / hedgeSpotScale;
+    x[1] = tau;
+    x[2] = vol;
+    x[3] = previousHedge;
+    x[4] = wealth / hedgeWealthScale;
+}
+
+// Hedge tanh(network(features)) from a FrozenNetwork-style evaluator, using
+// stack buffers only
+template <class Frozen>
+inline double hedgeRatio(const Frozen& network, double S, double tau, double vol, double previousHedge,
+                         double wealth) {
+    double x[hedgeFeatureCount];
+    float features[hedgeFeatureCount];
+    hedgeFeatures(x, S, tau, vol, previousHedge, wealth);
+    for (size_t k = 0; k < hedgeFeatureCount; ++k) features[k] = static_cast<float>(x[k]);
+    return std::tanh(network.evaluate(features));
+}
+
+// S_{i+1} = S_i exp(drift + diffusion z) for a row of paths, in place allowed
+template <class V>
+inline void advanceSpotStep(const double* S, const double* z, const double* drift, const double* diffusion,
+                            double* next, size_t p) {
+    (V::load(S + p) * simd::exp(V::load(drift + p) + V::load(diffusion + p) * V::load(z + p))).store(next + p);
+}
+
+inline void advanceSpots(const double* S, const double* z, const double* drift, const double* diffusion,
+                         double* next, size_t paths) {
+    using V = simd::Native;
+    size_t p = 0;
+    for (; p + V::width <= paths; p += V::width) advanceSpotStep<V>(S, z, drift, diffusion, next, p);
+    for (; p < paths; ++p) advanceSpotStep<simd::Scalar>(S, z, drift, diffusion, next, p);
+}
+
+// Move a row of paths to hedge tanh(output) at spot S, paying proportional
+// costs out of cash; previous and hedge may be the same array
+template <class V>
+inline void rebalanceStep(const double* output, const double* S, const double* previous, V cost, double* hedge,
+                          double* cash, double* wealth, size_t p) {
+    V d = simd::tanh(V::load(output + p)), s = V::load(S + p);
+    V trade = d - V::load(previous + p);
+    V c = V::load(cash + p) - simd::fma(cost, simd::abs(trade), trade) * s;
+    d.store(hedge + p);
+    c.store(cash + p);
+    simd::fma(d, s, c).store(wealth + p);
+}
+
+inline void rebalance(const double* output, const double* S, const double* previous, double transactionCost,
+                      double* hedge, double* cash, double* wealth, size_t paths) {
+    using V = simd::Native;
+    size_t p = 0;
+    for (; p + V::width <= paths; p += V::width) {
+        rebalanceStep<V>(output, S, previous, V(transactionCost), hedge, cash, wealth, p);
+    }
+    for (; p < paths; ++p) {
+        rebalanceStep<simd::Scalar>(output, S, previous, simd::Scalar(transactionCost), hedge, cash, wealth, p);
+    }
+}
+
+// Short call on GBM; initial spot and volatility are drawn per path
+struct HedgingMarket {
+    double spotLow = 80.0, spotHigh = 120.0;
+    double volLow = 0.16, volHigh = 0.24;
+    double strike = 100.0;
+    double maturity = 0.25;
+    double rate = 0.05;
+    double transactionCost = 0.001;
+    size_t steps = 50;
+};
+
+// How HedgingSimulator draws initial states and Brownian increments
+enum class PathSampling {
+    PseudoRandom,   // Philox uniforms and normals
+    SobolBridge     // Sobol points, the Brownian bridge and Philox beyond the Sobol dimensions
+};
+
+// Risk measure of the terminal P&L that training minimizes
+enum class HedgeObjective {
+    MeanSquare,   // E[P&L^2]
+    CVaR,         // expected loss in the worst (1 - cvarLevel) tail
+    Entropic      // log E[exp(-lambda P&L)] / lambda
+};
+
+struct TrainingSettings {
+    size_t minibatches = 100;
+    size_t batchPaths = 4096;
+    size_t shardPaths = 256;
+    double learningRate = 1e-3;
+    HedgeObjective objective = HedgeObjective::MeanSquare;
+    double cvarLevel = 0.95;
+    double riskAversion = 1.0;
+    uint64_t seed = 11;
+    size_t reportInterval = 10;   // minibatches between progress lines, 0 for none
+};
+
+struct TrainingReport {
+    std::vector<double> objective;   // per minibatch
+    size_t episodes = 0;
+    double seconds = 0.0;
+
+    double episodesPerSecond() const { return seconds > 0.0 ? episodes / seconds : 0.0; }
+};
+
+// Objective value over a batch of terminal P&L, with its gradient per path
+inline double hedgeObjective(const TrainingSettings& settings, const std::vector<double>& pnl,
+                             std::vector<double>& gradient) {
+    const size_t n = pnl.size();
+    gradient.assign(n, 0.0);
+    if (n == 0) return 0.0;
+
+    switch (settings.objective) {
+    case HedgeObjective::MeanSquare: {
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += pnl[i] * pnl[i];
+            gradient[i] = 2.0 * pnl[i] / n;
+        }
+        return sum / n;
+    }
+    case HedgeObjective::CVaR: {
+        // Mean of the k largest losses; ties broken by path index
+        const size_t k = std::max<size_t>(1, static_cast<size_t>(std::ceil((1.0 - settings.cvarLevel) * n)));
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::nth_element(order.begin(), order.begin() + (k - 1), order.end(), [&](size_t a, size_t b) {
+            return pnl[a] != pnl[b] ? pnl[a] < pnl[b] : a < b;
+        });
+        double sum = 0.0;
+        for (size_t j = 0; j < k; ++j) {
+            sum -= pnl[order[j]];
+            gradient[order[j]] = -1.0 / k;
+        }
+        return sum / k;
+    }
+    case HedgeObjective::Entropic: {
+        const double lambda = settings.riskAversion;
+        double shift = -lambda * pnl[0];
+        for (double x : pnl) shift = std::max(shift, -lambda * x);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            gradient[i] = std::exp(-lambda * pnl[i] - shift);
+            sum += gradient[i];
+        }
+        for (double& g : gradient) g = -g / sum;
+        return (shift + std::log(sum / n)) / lambda;
+    }
+    }
+    throw std::invalid_argument("hedgeObjective: unknown objective");
+}
+
+class HedgingTrainer {
+private:
+    // State of one shard of paths; step rows are time-major (step x paths)
+    struct Shard {
+        size_t paths = 0;
+        AlignedVector<double> spot;            // (steps + 1) x paths
+        AlignedVector<double> hedge, wealth;   // steps x paths, after each rebalance
+        AlignedVector<double> normals;         // steps x paths
+        AlignedVector<double> vol, drift, diffusion, cash, pnl, pnlGrad;
+        AlignedVector<double> adjHedge, adjCash, adjWealth, zeros;
+        AlignedVector<double> inputs, outputGrad, inputGrad;
+        AlignedVector<double> gradient;
+        NetworkWorkspace ws;
+    };
+
+    NeuralNetwork& network;
+    HedgingMarket market;
+    TrainingSettings settings;
+    AdamOptimizer adam;
+    std::vector<Shard> shards;
+    std::vector<double> batchPnl, batchGrad, gradient;
+    uint64_t minibatch = 0;
+
+    void buildInputs(Shard& sh, size_t i) const {
+        const size_t P = sh.paths;
+        const double* S = &sh.spot[i * P];
+        const double* previous = i > 0 ? &sh.hedge[(i - 1) * P] : sh.zeros.data();
+        const double* wealth = i > 0 ? &sh.wealth[(i - 1) * P] : sh.zeros.data();
+        const double tau = static_cast<double>(i) / market.steps;
+        for (size_t p = 0; p < P; ++p) {
+            hedgeFeatures(&sh.inputs[p * hedgeFeatureCount], S[p], tau, sh.vol[p], previous[p], wealth[p]);
+        }
+    }
+
+    // Market paths, then the hedging policy forward in time
+    void simulate(Shard& sh, uint64_t stream) const {
+        const size_t P = sh.paths, n = market.steps;
+        const double dt = market.maturity / n, sqrtDt = std::sqrt(dt);
+
+        Philox4x32 rng(settings.seed, stream);
+        for (size_t p = 0; p < P; ++p) {
+            sh.spot[p] = market.spotLow + (market.spotHigh - market.spotLow) * rng.uniform();
+            sh.vol[p] = market.volLow + (market.volHigh - market.volLow) * rng.uniform();
+            sh.drift[p] = (market.rate - 0.5 * sh.vol[p] * sh.vol[p]) * dt;
+            sh.diffusion[p] = sh.vol[p] * sqrtDt;
+        }
+        rng.fillNormal(sh.normals.data(), n * P);
+        for (size_t i = 0; i < n; ++i) {
+            advanceSpots(&sh.spot[i * P], &sh.normals[i * P], sh.drift.data(), sh.diffusion.data(),
+                         &sh.spot[(i + 1) * P], P);
+        }
+
+        std::fill(sh.cash.begin(), sh.cash.end(), 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            buildInputs(sh, i);
+            const double* out = network.forward(sh.inputs.data(), P, sh.ws);
+            const double* previous = i > 0 ? &sh.hedge[(i - 1) * P] : sh.zeros.data();
+            rebalance(out, &sh.spot[i * P], previous, market.transactionCost, &sh.hedge[i * P], sh.cash.data(),
+                      &sh.wealth[i * P], P);
+        }
+
+        const double* ST = &sh.spot[n * P];
+        const double* last = &sh.hedge[(n - 1) * P];
+        for (size_t p = 0; p < P; ++p) {
+            sh.pnl[p] = last[p] * ST[p] + sh.cash[p] - std::max(ST[p] - market.strike, 0.0);
+        }
+    }
+
+    // Reverse sweep from dObjective/dPnL to the shard's parameter gradient
+    void differentiate(Shard& sh) const {
+        const size_t P = sh.paths, n = market.steps;
+        const double tc = market.transactionCost;
+        std::fill(sh.gradient.begin(), sh.gradient.end(), 0.0);
+
+        // pnl = hedge[n-1] * S_n + cash[n-1] - payoff(S_n)
+        const double* ST = &sh.spot[n * P];
+        for (size_t p = 0; p < P; ++p) {
+            sh.adjHedge[p] = sh.pnlGrad[p] * ST[p];
+            sh.adjCash[p] = sh.pnlGrad[p];
+            sh.adjWealth[p] = 0.0;
+        }
+
+        for (size_t i = n; i-- > 0;) {
+            const double* S = &sh.spot[i * P];
+            const double* hedge = &sh.hedge[i * P];
+            const double* previous = i > 0 ? &sh.hedge[(i - 1) * P] : sh.zeros.data();
+            for (size_t p = 0; p < P; ++p) {
+                // wealth = hedge * S + cash
+                double adjHedge = sh.adjHedge[p] + sh.adjWealth[p] * S[p];
+                sh.adjCash[p] += sh.adjWealth[p];
+
+                // cash -= trade * S + tc * |trade| * S, trade = hedge - previous
+                const double trade = hedge[p] - previous[p];
+                const double sign = trade > 0.0 ? 1.0 : (trade < 0.0 ? -1.0 : 0.0);
+                const double adjTrade = -sh.adjCash[p] * S[p] * (1.0 + tc * sign);
+                adjHedge += adjTrade;
+
+                // hedge = tanh(output)
+                sh.outputGrad[p] = adjHedge * (1.0 - hedge[p] * hedge[p]);
+                sh.adjHedge[p] = -adjTrade;
+            }
+
+            buildInputs(sh, i);
+            network.forward(sh.inputs.data(), P, sh.ws);
+            network.backward(sh.outputGrad.data(), sh.ws, sh.gradient.data(), sh.inputGrad.data());
+            for (size_t p = 0; p < P; ++p) {
+                sh.adjHedge[p] += sh.inputGrad[p * hedgeFeatureCount + 3];
+                sh.adjWealth[p] = sh.inputGrad[p * hedgeFeatureCount + 4] / hedgeWealthScale;
+            }
+        }
+    }
+
+public:
+    HedgingTrainer(NeuralNetwork& net, const HedgingMarket& m, const TrainingSettings& s)
+        : network(net), market(m), settings(s), adam(net.parameterCount(), s.learningRate),
+          gradient(net.parameterCount()) {
+        if (network.inputSize() != hedgeFeatureCount || network.outputSize() != 1) {
+            throw std::invalid_argument("HedgingTrainer: network must map 5 features to one output");
+        }
+        if (market.steps == 0 || settings.batchPaths == 0 || settings.shardPaths == 0) {
+            throw std::invalid_argument("HedgingTrainer: steps, batch and shard sizes must be positive");
+        }
+
+        const size_t n = market.steps;
+        for (size_t first = 0; first < settings.batchPaths; first += settings.shardPaths) {
+            Shard sh;
+            const size_t P = std::min(settings.shardPaths, settings.batchPaths - first);
+            sh.paths = P;
+            sh.spot.resize((n + 1) * P);
+            sh.hedge.resize(n * P);
+            sh.wealth.resize(n * P);
+            sh.normals.resize(n * P);
+            for (auto* v : {&sh.vol, &sh.drift, &sh.diffusion, &sh.cash, &sh.pnl, &sh.pnlGrad, &sh.adjHedge,
+                            &sh.adjCash, &sh.adjWealth, &sh.zeros, &sh.outputGrad}) {
+                v->assign(P, 0.0);
+            }
+            sh.inputs.resize(P * hedgeFeatureCount);
+            sh.inputGrad.resize(P * hedgeFeatureCount);
+            sh.gradient.resize(network.parameterCount());
+            sh.ws = NetworkWorkspace(network, P);
+            shards.push_back(std::move(sh));
+        }
+    }
+
+    size_t episodesPerMinibatch() const { return settings.batchPaths; }
+
+    // One Adam step on a fresh minibatch; returns the objective before the step
+    double step(ThreadPool& pool = defaultThreadPool()) {
+        const uint64_t firstStream = minibatch * shards.size();
+        pool.parallelFor(shards.size(), [&](size_t s) { simulate(shards[s], firstStream + s); });
+
+        batchPnl.clear();
+        for (const Shard& sh : shards) batchPnl.insert(batchPnl.end(), sh.pnl.begin(), sh.pnl.end());
+        const double objective = hedgeObjective(settings, batchPnl, batchGrad);
+        size_t offset = 0;
+        for (Shard& sh : shards) {
+            std::copy(batchGrad.begin() + offset, batchGrad.begin() + offset + sh.paths, sh.pnlGrad.begin());
+            offset += sh.paths;
+        }
+
+        pool.parallelFor(shards.size(), [&](size_t s) { differentiate(shards[s]); });
+        std::fill(gradient.begin(), gradient.end(), 0.0);
+        for (const Shard& sh : shards) {
+            for (size_t k = 0; k < gradient.size(); ++k) gradient[k] += sh.gradient[k];
+        }
+        adam.step(network.parameters(), gradient.data());
+        ++minibatch;
+        return objective;
+    }
+
+    // Terminal P&L of the last simulated minibatch
+    const std::vector<double>& lastPnl() const { return batchPnl; }
+};
+
+// Terminal P&L of a hedging network on many paths, forward only
+class HedgingSimulator {
+private:
+    static constexpr size_t chunkPaths = 256;
+
+    struct Scratch {
+        AlignedVector<double> spot, vol, drift, diffusion, hedge, cash, wealth, normals, inputs;
+        AlignedVector<double> bridge;   // steps x paths bridge coordinates
+        NetworkWorkspace ws;
+    };
+
+    const NeuralNetwork& network;
+    HedgingMarket market;
+    PathSampling sampling;
+    BrownianBridge bridge;
+
+    // Sobol point first + p drives path p: coordinates 0 and 1 pick the
+    // initial spot and volatility and the rest the leading bridge coordinates;
+    // Philox fills the bridge coordinates past the Sobol dimensions. All
+    // steps x P increments are built up front, step i in row i of s.normals.
+    void sobolPaths(Scratch& s, size_t P, uint64_t first, Philox4x32& rng) const {
+        const size_t n = market.steps;
+        const size_t quasi = std::min(n, SobolSequence::maxDimension - 2);
+        SobolSequence sobol(quasi + 2, first);
+        double point[SobolSequence::maxDimension];
+        for (size_t p = 0; p < P; ++p) {
+            sobol.next(point);
+            s.spot[p] = market.spotLow + (market.spotHigh - market.spotLow) * point[0];
+            s.vol[p] = market.volLow + (market.volHigh - market.volLow) * point[1];
+            for (size_t i = 0; i < quasi; ++i) s.bridge[i * P + p] = point[i + 2];
+        }
+        inverseNormalCdf(s.bridge.data(), s.bridge.data(), quasi * P);
+        rng.fillNormal(&s.bridge[quasi * P], (n - quasi) * P);
+        bridge.build(s.bridge.data(), s.normals.data(), P);
+    }
+
+    void chunk(Scratch& s, double* pnl, size_t P, uint64_t seed, uint64_t stream) const {
+        const size_t n = market.steps;
+        const double dt = market.maturity / n, sqrtDt = std::sqrt(dt);
+        const bool quasi = sampling == PathSampling::SobolBridge;
+
+        Philox4x32 rng(seed, stream);
+        if (quasi) {
+            sobolPaths(s, P, stream * chunkPaths + 1, rng);
+        } else {
+            for (size_t p = 0; p < P; ++p) {
+                s.spot[p] = market.spotLow + (market.spotHigh - market.spotLow) * rng.uniform();
+                s.vol[p] = market.volLow + (market.volHigh - market.volLow) * rng.uniform();
+            }
+        }
+        for (size_t p = 0; p < P; ++p) {
+            s.drift[p] = (market.rate - 0.5 * s.vol[p] * s.vol[p]) * dt;
+            s.diffusion[p] = s.vol[p] * sqrtDt;
+        }
+        std::fill(s.hedge.begin(), s.hedge.begin() + P, 0.0);
+        std::fill(s.cash.begin(), s.cash.begin() + P, 0.0);
+        std::fill(s.wealth.begin(), s.wealth.begin() + P, 0.0);
+
+        for (size_t i = 0; i < n; ++i) {
+            const double tau = static_cast<double>(i) / n;
+            for (size_t p = 0; p < P; ++p) {
+                hedgeFeatures(&s.inputs[p * hedgeFeatureCount], s.spot[p], tau, s.vol[p], s.hedge[p], s.wealth[p]);
+            }
+            const double* out = network.forward(s.inputs.data(), P, s.ws);
+            rebalance(out, s.spot.data(), s.hedge.data(), market.transactionCost, s.hedge.data(), s.cash.data(),
+                      s.wealth.data(), P);
+            const double* z = s.normals.data();
+            if (quasi) {
+                z += i * P;
+            } else {
+                rng.fillNormal(s.normals.data(), P);
+            }
+            advanceSpots(s.spot.data(), z, s.drift.data(), s.diffusion.data(), s.spot.data(), P);
+        }
+        for (size_t p = 0; p < P; ++p) {
+            pnl[p] = s.hedge[p] * s.spot[p] + s.cash[p] - std::max(s.spot[p] - market.strike, 0.0);
+        }
+    }
+
+public:
+    HedgingSimulator(const NeuralNetwork& net, const HedgingMarket& m,
+                     PathSampling pathSampling = PathSampling::PseudoRandom)
+        : network(net), market(m), sampling(pathSampling), bridge(std::max<size_t>(m.steps, 1)) {
+        if (network.inputSize() != hedgeFeatureCount || network.outputSize() != 1) {
+            throw std::invalid_argument("HedgingSimulator: network must map 5 features to one output");
+        }
+        if (market.steps == 0) throw std::invalid_argument("HedgingSimulator: steps must be positive");
+    }
+
+    // pnl[0, paths); chunk c of paths draws from Philox stream c and Sobol
+    // points from c * chunkPaths + 1, so results do not depend on the thread count
+    void simulate(double* pnl, size_t paths, uint64_t seed, ThreadPool& pool = defaultThreadPool()) const {
+        const size_t chunks = (paths + chunkPaths - 1) / chunkPaths;
+        const bool quasi = sampling == PathSampling::SobolBridge;
+        const size_t rows = quasi ? market.steps : 1;
+        pool.parallelFor(chunks, [&](size_t c) {
+            thread_local Scratch scratch;
+            if (scratch.spot.size() < chunkPaths) {
+                for (auto* v : {&scratch.spot, &scratch.vol, &scratch.drift, &scratch.diffusion, &scratch.hedge,
+                                &scratch.cash, &scratch.wealth}) {
+                    v->resize(chunkPaths);
+                }
+                scratch.inputs.resize(chunkPaths * hedgeFeatureCount);
+            }
+            if (scratch.normals.size() < rows * chunkPaths) scratch.normals.resize(rows * chunkPaths);
+            if (quasi && scratch.bridge.size() < rows * chunkPaths) scratch.bridge.resize(rows * chunkPaths);
+            if (!scratch.ws.fits(network, chunkPaths)) scratch.ws = NetworkWorkspace(network, chunkPaths);
+            const size_t first = c * chunkPaths;
+            chunk(scratch, pnl + first, std::min(chunkPaths, paths - first), seed, c);
+        });
+    }
+
+    std::vector<double> simulate(size_t paths, uint64_t seed, ThreadPool& pool = defaultThreadPool()) const {
+        std::vector<double> pnl(paths);
+        simulate(pnl.data(), paths, seed, pool);
+        return pnl;
+    }
+};
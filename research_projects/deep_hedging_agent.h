@@ -0,0 +1,82 @@
+// Deep hedging agent (Buehler et al. 2019): a 5-32-32-1 network trained with
+// HedgingTrainer, evaluated with HedgingSimulator and frozen for low-latency
+// inference
+
+#pragma once
+
+#include "deep_hedging.h"
+#include "hedge_inference.h"
+#include "neural_network.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <InferencePrecision P>
+using FrozenHedgeNetwork = FrozenNetwork<P, 5, 32, 32, 1>;
+
+class DeepHedgingAgent {
+private:
+    NeuralNetwork network;
+    double transaction_cost;
+    
+public:
+    DeepHedgingAgent(double tc = 0.001) 
+        : network({5, 32, 32, 1}), transaction_cost(tc) {}
+    
+    // Get hedging position based on market state
+    double getHedgeRatio(double S, double t, double vol, double delta_prev, double pnl) {
+        std::vector<double> features(hedgeFeatureCount);
+        hedgeFeatures(features.data(), S, t, vol, delta_prev, pnl);
+        auto output = network.forward(features);
+        return std::tanh(output[0]); // Bounded between -1 and 1
+    }
+    
+    // Terminal P&L of the network's hedge on a batch of simulated paths
+    std::vector<double> simulateHedging(double S0, double K, double T, double vol, double r = 0.05,
+                                        size_t paths = 100000, uint64_t seed = 1,
+                                        PathSampling sampling = PathSampling::PseudoRandom) const {
+        HedgingMarket market;
+        market.spotLow = market.spotHigh = S0;
+        market.volLow = market.volHigh = vol;
+        market.strike = K;
+        market.maturity = T;
+        market.rate = r;
+        market.transactionCost = transaction_cost;
+        return HedgingSimulator(network, market, sampling).simulate(paths, seed);
+    }
+    
+    // Train with Adam on batched, lock-step simulated minibatches
+    TrainingReport train(const TrainingSettings& settings = TrainingSettings()) {
+        std::cout << "Training Deep Hedging Agent...\n";
+        
+        HedgingMarket market;
+        market.transactionCost = transaction_cost;
+        HedgingTrainer trainer(network, market, settings);
+        
+        TrainingReport report;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t m = 0; m < settings.minibatches; ++m) {
+            report.objective.push_back(trainer.step());
+            report.episodes += trainer.episodesPerMinibatch();
+            
+            if (settings.reportInterval && (m % settings.reportInterval == 0 || m + 1 == settings.minibatches)) {
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "Minibatch " << m << ", Objective: " << report.objective.back()
+                          << ", Episodes/s: " << report.episodes / elapsed << std::endl;
+            }
+        }
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+    
+    // Frozen copy of the current weights for low-latency inference
+    template <InferencePrecision P>
+    FrozenHedgeNetwork<P> freeze() const { return FrozenHedgeNetwork<P>(network); }
+    
+    void saveCheckpoint(const std::string& path) const { writeNetworkCheckpoint(path, network); }
+    void loadCheckpoint(const std::string& path) { network = readNetworkCheckpoint(path); }
+};
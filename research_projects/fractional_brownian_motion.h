@@ -0,0 +1,122 @@
+// Exact fractional Brownian motion by circulant embedding (Davies & Harte, 1987)
+// The autocovariance of fractional Gaussian noise is embedded in a circulant
+// matrix of size 2m (m = steps rounded up to a power of two). Its eigenvalues
+// are one FFT of the first row and are cached per (steps, H). A path then
+// costs one FFT of complex white noise scaled by sqrt(eigenvalue); the real
+// and imaginary parts are two independent exact samples, so each transform
+// yields a pair of paths.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/fft.h"
+#include "../common/random.h"
+#include "../common/thread_pool.h"
+#include "path_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+// sqrt(lambda_k / 2m) for the circulant embedding of unit-step fGn
+class FbmSpectrum {
+private:
+    size_t stepCount;
+    FftPlan fft;
+    AlignedVector<double> amplitude;
+
+    // Autocovariance of unit-step fractional Gaussian noise
+    static double autocovariance(size_t k, double H) {
+        double x = static_cast<double>(k);
+        return 0.5 * (std::pow(x + 1.0, 2 * H) - 2.0 * std::pow(x, 2 * H) + std::pow(std::abs(x - 1.0), 2 * H));
+    }
+
+public:
+    FbmSpectrum(size_t steps, double H) : stepCount(steps) {
+        if (steps == 0 || !(H > 0.0 && H < 1.0)) throw std::invalid_argument("FbmSpectrum: need steps > 0, 0 < H < 1");
+        size_t m = 1;
+        while (m < steps) m *= 2;
+        const size_t M = 2 * m;
+        fft = FftPlan(M);
+
+        // First row of the circulant: c_0..c_m, then c_{m-1}..c_1
+        AlignedVector<double> re(M), im(M, 0.0);
+        for (size_t k = 0; k <= m; ++k) re[k] = autocovariance(k, H);
+        for (size_t k = m + 1; k < M; ++k) re[k] = re[M - k];
+        fft.forward(re.data(), im.data());
+
+        amplitude.resize(M);
+        const double largest = *std::max_element(re.begin(), re.end());
+        for (size_t k = 0; k < M; ++k) {
+            // The fGn embedding is non-negative definite; clip round-off only
+            if (re[k] < -1e-10 * largest) throw std::runtime_error("FbmSpectrum: negative circulant eigenvalue");
+            amplitude[k] = std::sqrt(std::max(re[k], 0.0) / static_cast<double>(M));
+        }
+    }
+
+    size_t steps() const { return stepCount; }
+    size_t embeddingSize() const { return fft.size(); }
+    const FftPlan& plan() const { return fft; }
+    const double* amplitudes() const { return amplitude.data(); }
+
+    // Shared, lazily built spectrum for (steps, H). Calibration visits many H
+    // values, so the cache is dropped once it grows past a few hundred entries.
+    static std::shared_ptr<const FbmSpectrum> get(size_t steps, double H) {
+        static std::mutex mutex;
+        static std::map<std::pair<size_t, double>, std::shared_ptr<const FbmSpectrum>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cache.size() >= 256) cache.clear();
+        auto& entry = cache[{steps, H}];
+        if (!entry) entry = std::make_shared<const FbmSpectrum>(steps, H);
+        return entry;
+    }
+};
+
+// Fill batch with fBM levels B_H(t_i), t_i = i T / steps, B_H(0) = 0.
+// Paths are numbered globally from firstPath; each pair (2k, 2k+1) draws from
+// Philox stream k, so a run split into batches reproduces the same paths
+// whatever the batch boundaries and thread count.
+inline void generateFbm(PathMatrix& batch, double H, double T, uint64_t seed, uint64_t firstPath = 0,
+                        ThreadPool& pool = defaultThreadPool()) {
+    if (firstPath % 2 != 0) throw std::invalid_argument("generateFbm: firstPath must be even");
+    const size_t n = batch.steps();
+    const auto spectrum = FbmSpectrum::get(n, H);
+    const size_t M = spectrum->embeddingSize();
+    const double* amplitude = spectrum->amplitudes();
+    const double scale = std::pow(T / n, H);
+    const size_t pairs = (batch.paths() + 1) / 2;
+
+    pool.parallelFor(pairs, [&](size_t pair) {
+        thread_local AlignedVector<double> re, im;
+        re.resize(M);
+        im.resize(M);
+
+        Philox4x32 rng(seed, firstPath / 2 + pair);
+        rng.fillNormal(re.data(), M);
+        rng.fillNormal(im.data(), M);
+        for (size_t k = 0; k < M; ++k) {
+            re[k] *= amplitude[k];
+            im[k] *= amplitude[k];
+        }
+        spectrum->plan().forward(re.data(), im.data());
+
+        // Cumulative sums of the first n noise terms give the levels
+        const double* noise[2] = {re.data(), im.data()};
+        for (size_t j = 0; j < 2; ++j) {
+            size_t p = 2 * pair + j;
+            if (p >= batch.paths()) break;
+            double* out = batch.path(p);
+            double level = 0.0;
+            out[0] = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                level += scale * noise[j][i];
+                out[i + 1] = level;
+            }
+        }
+    });
+}
@@ -0,0 +1,288 @@
+// Frozen low-latency inference for trained networks
+// FrozenNetwork<Precision, Sizes...> copies a NeuralNetwork (or a checkpoint)
+// once into 64-byte aligned arrays whose shapes are template parameters, so a
+// call runs on stack buffers and never touches the heap. Buffers are padded
+// to 16 floats with zeros, which lets every layer use whole vectors.
+// - Float32: wide layers accumulate broadcast(x_i) * W[i][:] in register
+//   tiles over independent partial sums; narrow layers (fewer outputs than
+//   lanes, e.g. the final one) take dot products against W^T.
+// - Int8: every layer after the first uses symmetric per-output int8 weights
+//   and quantizes its (post-ReLU, non-negative) input per call to 7-bit
+//   unsigned values, summed in int32 with AVX-512 VNNI dot products, AVX2
+//   maddubs (7 bits keep its int16 pairs from saturating) or scalar code.
+//   The first layer stays float because the raw features are signed.
+
+#pragma once
+
+#include "../common/simd.h"
+#include "neural_network.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+enum class InferencePrecision { Float32, Int8 };
+
+namespace frozen {
+
+constexpr size_t padding = 16;
+
+constexpr size_t padded(size_t n) { return (n + padding - 1) / padding * padding; }
+
+// y = W^T x + b in float, W given as In x Out row-major doubles
+template <size_t In, size_t Out>
+class FloatLayer {
+private:
+    using V = simd::NativeFloat;
+    static constexpr bool wide = Out >= static_cast<size_t>(V::width);
+    static constexpr size_t stride = wide ? padded(Out) : padded(In);
+    static constexpr size_t rows = wide ? In : Out;
+    // Register tile: up to 8 vectors of outputs, each summed over up to four
+    // independent chains of inputs so the FMA latency is hidden
+    static constexpr size_t vectors = stride / V::width;
+    static constexpr size_t blockVectors = vectors % 8 == 0 ? 8 : vectors % 4 == 0 ? 4 : vectors % 2 == 0 ? 2 : 1;
+    static constexpr size_t chains = std::min<size_t>(4, 16 / blockVectors);
+
+    alignas(64) float weight[rows * stride] = {};
+    alignas(64) float bias[padded(Out)] = {};
+
+public:
+    void load(const double* W, const double* b) {
+        for (size_t i = 0; i < In; ++i) {
+            for (size_t j = 0; j < Out; ++j) {
+                float w = static_cast<float>(W[i * Out + j]);
+                if (wide) weight[i * stride + j] = w;
+                else weight[j * stride + i] = w;
+            }
+        }
+        for (size_t j = 0; j < Out; ++j) bias[j] = static_cast<float>(b[j]);
+    }
+
+    // x holds padded(In) floats, y receives padded(Out)
+    template <bool Relu>
+    void apply(const float* x, float* y) const {
+        if constexpr (wide) {
+            for (size_t j = 0; j < stride; j += blockVectors * V::width) {
+                V acc[chains][blockVectors];
+                for (size_t v = 0; v < blockVectors; ++v) {
+                    acc[0][v] = V::load(bias + j + v * V::width);
+                    for (size_t c = 1; c < chains; ++c) acc[c][v] = V(0.0f);
+                }
+                for (size_t i = 0; i < In; i += chains) {
+                    for (size_t c = 0; c < chains && i + c < In; ++c) {
+                        V xi(x[i + c]);
+                        const float* row = weight + (i + c) * stride + j;
+                        for (size_t v = 0; v < blockVectors; ++v) {
+                            acc[c][v] = simd::fma(xi, V::load(row + v * V::width), acc[c][v]);
+                        }
+                    }
+                }
+                for (size_t v = 0; v < blockVectors; ++v) {
+                    V sum = acc[0][v];
+                    for (size_t c = 1; c < chains; ++c) sum = sum + acc[c][v];
+                    if (Relu) sum = simd::max(sum, V(0.0f));
+                    sum.store(y + j + v * V::width);
+                }
+            }
+        } else {
+            for (size_t j = 0; j < Out; ++j) {
+                const float* row = weight + j * stride;
+                V acc0(0.0f), acc1(0.0f);
+                size_t i = 0;
+                for (; i + 2 * V::width <= stride; i += 2 * V::width) {
+                    acc0 = simd::fma(V::load(x + i), V::load(row + i), acc0);
+                    acc1 = simd::fma(V::load(x + i + V::width), V::load(row + i + V::width), acc1);
+                }
+                for (; i < stride; i += V::width) acc0 = simd::fma(V::load(x + i), V::load(row + i), acc0);
+                float value = simd::reduceAdd(acc0 + acc1) + bias[j];
+                y[j] = Relu ? std::max(value, 0.0f) : value;
+            }
+            std::fill(y + Out, y + padded(Out), 0.0f);
+        }
+    }
+};
+
+// y = scale_x * scale_j * (q(x) . q(W_j)) + b_j with int8 weights and 7-bit
+// unsigned activations; x must be non-negative
+template <size_t In, size_t Out>
+class Int8Layer {
+private:
+    static constexpr size_t groups = (In + 3) / 4;
+    static constexpr size_t outputs = padded(Out);
+
+    // VNNI layout: for each group of four inputs, four bytes per output
+    alignas(64) int8_t weight[groups * outputs * 4] = {};
+    alignas(64) float scale[outputs] = {};
+    alignas(64) float bias[outputs] = {};
+
+    void accumulate(const uint8_t* q, int32_t* acc) const {
+#if defined(__AVX512VNNI__)
+        for (size_t o = 0; o < outputs; o += 16) {
+            __m512i sum0 = _mm512_setzero_si512(), sum1 = _mm512_setzero_si512();
+            size_t g = 0;
+            for (; g + 2 <= groups; g += 2) {
+                int32_t x0, x1;
+                std::memcpy(&x0, q + 4 * g, 4);
+                std::memcpy(&x1, q + 4 * g + 4, 4);
+                sum0 = _mm512_dpbusd_epi32(sum0, _mm512_set1_epi32(x0),
+                                           _mm512_load_si512(weight + (g * outputs + o) * 4));
+                sum1 = _mm512_dpbusd_epi32(sum1, _mm512_set1_epi32(x1),
+                                           _mm512_load_si512(weight + ((g + 1) * outputs + o) * 4));
+            }
+            if (g < groups) {
+                int32_t x0;
+                std::memcpy(&x0, q + 4 * g, 4);
+                sum0 = _mm512_dpbusd_epi32(sum0, _mm512_set1_epi32(x0),
+                                           _mm512_load_si512(weight + (g * outputs + o) * 4));
+            }
+            _mm512_store_si512(acc + o, _mm512_add_epi32(sum0, sum1));
+        }
+#elif defined(__AVX2__)
+        const __m256i ones = _mm256_set1_epi16(1);
+        for (size_t o = 0; o < outputs; o += 8) {
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t g = 0; g < groups; ++g) {
+                int32_t x;
+                std::memcpy(&x, q + 4 * g, 4);
+                __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weight + (g * outputs + o) * 4));
+                __m256i pairs = _mm256_maddubs_epi16(_mm256_set1_epi32(x), w);
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(acc + o), sum);
+        }
+#else
+        for (size_t o = 0; o < outputs; ++o) {
+            int32_t sum = 0;
+            for (size_t g = 0; g < groups; ++g) {
+                for (size_t k = 0; k < 4; ++k) sum += int32_t(q[4 * g + k]) * weight[(g * outputs + o) * 4 + k];
+            }
+            acc[o] = sum;
+        }
+#endif
+    }
+
+public:
+    void load(const double* W, const double* b) {
+        for (size_t j = 0; j < Out; ++j) {
+            double largest = 0.0;
+            for (size_t i = 0; i < In; ++i) largest = std::max(largest, std::abs(W[i * Out + j]));
+            const double s = largest > 0.0 ? largest / 127.0 : 1.0;
+            for (size_t i = 0; i < In; ++i) {
+                weight[((i / 4) * outputs + j) * 4 + i % 4] = static_cast<int8_t>(std::lround(W[i * Out + j] / s));
+            }
+            scale[j] = static_cast<float>(s);
+            bias[j] = static_cast<float>(b[j]);
+        }
+    }
+
+    template <bool Relu>
+    void apply(const float* x, float* y) const {
+        using V = simd::NativeFloat;
+        V high(0.0f);
+        for (size_t i = 0; i < padded(In); i += V::width) high = simd::max(high, V::load(x + i));
+        const float largest = simd::reduceMax(high);
+        const float inverse = largest > 0.0f ? 127.0f / largest : 0.0f;
+        const float step = largest / 127.0f;
+
+        alignas(64) uint8_t q[padded(4 * groups)];
+#if defined(__AVX512F__)
+        for (size_t i = 0; i < padded(4 * groups); i += 16) {
+            __m512i rounded = _mm512_cvtps_epi32(_mm512_mul_ps(_mm512_load_ps(x + i), _mm512_set1_ps(inverse)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(q + i), _mm512_cvtusepi32_epi8(rounded));
+        }
+#else
+        for (size_t i = 0; i < padded(4 * groups); ++i) q[i] = static_cast<uint8_t>(x[i] * inverse + 0.5f);
+#endif
+        alignas(64) int32_t acc[outputs];
+        accumulate(q, acc);
+
+        for (size_t j = 0; j < outputs; j += V::width) {
+            alignas(64) float dot[V::width];
+            for (int k = 0; k < V::width; ++k) dot[k] = static_cast<float>(acc[j + k]);
+            V value = simd::fma(V::load(dot) * V(step), V::load(scale + j), V::load(bias + j));
+            if (Relu) value = simd::max(value, V(0.0f));
+            value.store(y + j);
+        }
+    }
+};
+
+template <InferencePrecision P, bool First, size_t In, size_t Out>
+using Layer = std::conditional_t<P == InferencePrecision::Int8 && !First, Int8Layer<In, Out>, FloatLayer<In, Out>>;
+
+// Layers In -> Out -> Rest..., ReLU on all but the last
+template <InferencePrecision P, bool First, size_t In, size_t Out, size_t... Rest>
+struct LayerChain {
+    Layer<P, First, In, Out> layer;
+    LayerChain<P, false, Out, Rest...> next;
+
+    void load(const double* params) {
+        layer.load(params, params + In * Out);
+        next.load(params + In * Out + Out);
+    }
+
+    void run(float* x, float* y, float* output) const {
+        layer.template apply<true>(x, y);
+        next.run(y, x, output);
+    }
+};
+
+template <InferencePrecision P, bool First, size_t In, size_t Out>
+struct LayerChain<P, First, In, Out> {
+    Layer<P, First, In, Out> layer;
+
+    void load(const double* params) { layer.load(params, params + In * Out); }
+
+    void run(float* x, float* y, float* output) const {
+        layer.template apply<false>(x, y);
+        std::copy(y, y + Out, output);
+    }
+};
+
+} // namespace frozen
+
+template <InferencePrecision P, size_t... Sizes>
+class FrozenNetwork {
+private:
+    static_assert(sizeof...(Sizes) >= 2, "FrozenNetwork: need at least two layers");
+    static constexpr std::array<size_t, sizeof...(Sizes)> sizes = {Sizes...};
+    static constexpr size_t widest = std::max({frozen::padded(Sizes)...});
+
+    frozen::LayerChain<P, true, Sizes...> chain;
+
+public:
+    static constexpr size_t inputSize = sizes.front();
+    static constexpr size_t outputSize = sizes.back();
+
+    explicit FrozenNetwork(const NeuralNetwork& network) {
+        const auto& shape = network.layerSizes();
+        if (shape.size() != sizes.size() || !std::equal(shape.begin(), shape.end(), sizes.begin(),
+                                                        [](int a, size_t b) { return static_cast<size_t>(a) == b; })) {
+            throw std::invalid_argument("FrozenNetwork: layer sizes do not match the template shape");
+        }
+        chain.load(network.parameters());
+    }
+
+    static FrozenNetwork fromCheckpoint(const std::string& path) { return FrozenNetwork(readNetworkCheckpoint(path)); }
+
+    // output[0, outputSize) from input[0, inputSize)
+    void evaluate(const float* input, float* output) const {
+        alignas(64) float x[widest];
+        alignas(64) float y[widest];
+        std::copy(input, input + inputSize, x);
+        std::fill(x + inputSize, x + frozen::padded(inputSize), 0.0f);
+        chain.run(x, y, output);
+    }
+
+    float evaluate(const float* input) const {
+        static_assert(outputSize == 1, "FrozenNetwork: scalar evaluate needs a single output");
+        float out;
+        evaluate(input, &out);
+        return out;
+    }
+};
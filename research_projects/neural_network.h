@@ -0,0 +1,276 @@
+// Fully connected ReLU network with batched forward and backward passes
+// All weights and biases live in one contiguous parameter vector: per layer a
+// row-major (inputs x outputs) weight matrix followed by the biases. A batch
+// of samples is a row-major (batch x features) matrix, so every layer is one
+// blocked SIMD GEMM. Activations and deltas go to a caller-owned workspace
+// sized once, so repeated passes do not allocate. Trained weights go to a
+// small binary checkpoint:
+//   header (magic "QFNNET01", version, layer count, parameter count)
+//   | layer sizes (uint32) | parameters (double, the flat layout above)
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/gemm.h"
+#include "../common/random.h"
+#include "../common/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class NeuralNetwork;
+
+// Per-batch buffers for forward and backward passes
+class NetworkWorkspace {
+private:
+    friend class NeuralNetwork;
+    size_t capacity = 0;
+    size_t batch = 0;
+    std::vector<AlignedVector<double>> activation;   // [0] inputs, [l + 1] output of layer l
+    std::vector<AlignedVector<double>> delta;        // gradient w.r.t. the same values
+    AlignedVector<double> transposed;                // scratch for transposed operands
+
+public:
+    NetworkWorkspace() = default;
+    NetworkWorkspace(const NeuralNetwork& network, size_t maxBatch);
+
+    size_t maxBatch() const { return capacity; }
+    // Sized for batches of up to batch samples through this network's shape
+    bool fits(const NeuralNetwork& network, size_t batch) const;
+    const double* output() const { return activation.back().data(); }
+};
+
+class NeuralNetwork {
+private:
+    std::vector<int> sizes;
+    std::vector<size_t> weightOffset, biasOffset;
+    AlignedVector<double> params;
+
+    size_t layers() const { return sizes.size() - 1; }
+
+    // z = z + b, then ReLU on hidden layers
+    template <class V>
+    static void biasActivate(double* z, const double* b, size_t j, bool relu) {
+        V x = V::load(z + j) + V::load(b + j);
+        if (relu) x = simd::max(x, V(0.0));
+        x.store(z + j);
+    }
+
+public:
+    NeuralNetwork(const std::vector<int>& layerSizes, uint64_t seed = 1) : sizes(layerSizes) {
+        if (sizes.size() < 2) throw std::invalid_argument("NeuralNetwork: need at least two layers");
+        size_t offset = 0;
+        for (size_t l = 0; l < layers(); ++l) {
+            weightOffset.push_back(offset);
+            offset += static_cast<size_t>(sizes[l]) * sizes[l + 1];
+            biasOffset.push_back(offset);
+            offset += sizes[l + 1];
+        }
+        params.resize(offset);
+
+        Philox4x32 rng(seed);
+        for (double& p : params) p = 0.1 * rng.normal();
+    }
+
+    const std::vector<int>& layerSizes() const { return sizes; }
+    size_t inputSize() const { return sizes.front(); }
+    size_t outputSize() const { return sizes.back(); }
+
+    // Flat parameter vector; gradients use the same layout
+    size_t parameterCount() const { return params.size(); }
+    double* parameters() { return params.data(); }
+    const double* parameters() const { return params.data(); }
+
+    // Outputs for a batch of inputs (batch x inputSize, row-major), left in
+    // ws.output() as batch x outputSize
+    const double* forward(const double* inputs, size_t batch, NetworkWorkspace& ws) const {
+        using V = simd::Native;
+        if (batch > ws.capacity) throw std::invalid_argument("NeuralNetwork: batch exceeds workspace");
+        ws.batch = batch;
+        std::copy(inputs, inputs + batch * sizes[0], ws.activation[0].begin());
+
+        for (size_t l = 0; l < layers(); ++l) {
+            const size_t in = sizes[l], out = sizes[l + 1];
+            const double* W = &params[weightOffset[l]];
+            const double* b = &params[biasOffset[l]];
+            double* Z = ws.activation[l + 1].data();
+            gemm::multiply(batch, out, in, ws.activation[l].data(), in, W, out, Z, out);
+
+            const bool relu = l + 1 < layers();
+            for (size_t r = 0; r < batch; ++r) {
+                double* row = Z + r * out;
+                size_t j = 0;
+                for (; j + V::width <= out; j += V::width) biasActivate<V>(row, b, j, relu);
+                for (; j < out; ++j) biasActivate<simd::Scalar>(row, b, j, relu);
+            }
+        }
+        return ws.output();
+    }
+
+    // Back-propagate outputGrad (batch x outputSize) through the last forward
+    // pass in ws. Parameter gradients are added to gradient; the gradient with
+    // respect to the inputs is written to inputGrad when it is not null.
+    void backward(const double* outputGrad, NetworkWorkspace& ws, double* gradient, double* inputGrad = nullptr) const {
+        const size_t batch = ws.batch;
+        std::copy(outputGrad, outputGrad + batch * sizes.back(), ws.delta[layers()].begin());
+
+        for (size_t l = layers(); l-- > 0;) {
+            const size_t in = sizes[l], out = sizes[l + 1];
+            double* D = ws.delta[l + 1].data();
+
+            // ReLU passes gradient only where the unit was active
+            if (l + 1 < layers()) {
+                const double* A = ws.activation[l + 1].data();
+                for (size_t i = 0; i < batch * out; ++i) D[i] = A[i] > 0.0 ? D[i] : 0.0;
+            }
+
+            // dW += A_l^T D, db += column sums of D
+            gemm::transpose(batch, in, ws.activation[l].data(), in, ws.transposed.data(), batch);
+            gemm::multiply(in, out, batch, ws.transposed.data(), batch, D, out, gradient + weightOffset[l], out, 1.0);
+            double* db = gradient + biasOffset[l];
+            for (size_t r = 0; r < batch; ++r) {
+                for (size_t j = 0; j < out; ++j) db[j] += D[r * out + j];
+            }
+
+            // D_l = D W^T
+            if (l > 0 || inputGrad) {
+                gemm::transpose(in, out, &params[weightOffset[l]], out, ws.transposed.data(), in);
+                double* target = l > 0 ? ws.delta[l].data() : inputGrad;
+                gemm::multiply(batch, in, out, D, out, ws.transposed.data(), in, target, in);
+            }
+        }
+    }
+
+    // Single-sample convenience wrapper
+    std::vector<double> forward(const std::vector<double>& input) const {
+        thread_local NetworkWorkspace ws;
+        if (!ws.fits(*this, 1)) ws = NetworkWorkspace(*this, 1);
+        const double* out = forward(input.data(), 1, ws);
+        return std::vector<double>(out, out + outputSize());
+    }
+};
+
+inline NetworkWorkspace::NetworkWorkspace(const NeuralNetwork& network, size_t maxBatch) : capacity(maxBatch) {
+    const auto& sizes = network.layerSizes();
+    size_t widest = 0;
+    for (int s : sizes) {
+        activation.emplace_back(maxBatch * s);
+        delta.emplace_back(maxBatch * s);
+        widest = std::max<size_t>(widest, s);
+    }
+    transposed.resize(std::max(maxBatch, widest) * widest);
+}
+
+inline bool NetworkWorkspace::fits(const NeuralNetwork& network, size_t batch) const {
+    const auto& sizes = network.layerSizes();
+    if (batch > capacity || activation.size() != sizes.size()) return false;
+    for (size_t l = 0; l < sizes.size(); ++l) {
+        if (activation[l].size() != capacity * sizes[l]) return false;
+    }
+    return true;
+}
+
+// Adam on a flat parameter vector (Kingma & Ba 2015), with bias correction
+class AdamOptimizer {
+private:
+    AlignedVector<double> m, v;
+    double rate, beta1, beta2, epsilon;
+    double beta1Power = 1.0, beta2Power = 1.0;
+    uint64_t steps = 0;
+
+public:
+    explicit AdamOptimizer(size_t parameterCount, double learningRate = 1e-3, double b1 = 0.9,
+                           double b2 = 0.999, double eps = 1e-8)
+        : m(parameterCount, 0.0), v(parameterCount, 0.0), rate(learningRate), beta1(b1), beta2(b2),
+          epsilon(eps) {}
+
+    uint64_t iterations() const { return steps; }
+    void setLearningRate(double learningRate) { rate = learningRate; }
+
+    void step(double* params, const double* gradient) {
+        ++steps;
+        beta1Power *= beta1;
+        beta2Power *= beta2;
+        const double stepSize = rate * std::sqrt(1.0 - beta2Power) / (1.0 - beta1Power);
+        const double scaledEpsilon = epsilon * std::sqrt(1.0 - beta2Power);
+        for (size_t i = 0; i < m.size(); ++i) {
+            m[i] = beta1 * m[i] + (1.0 - beta1) * gradient[i];
+            v[i] = beta2 * v[i] + (1.0 - beta2) * gradient[i] * gradient[i];
+            params[i] -= stepSize * m[i] / (std::sqrt(v[i]) + scaledEpsilon);
+        }
+    }
+};
+
+struct NetworkCheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t layerCount;
+    uint64_t parameterCount;
+};
+
+constexpr char networkCheckpointMagic[8] = {'Q', 'F', 'N', 'N', 'E', 'T', '0', '1'};
+// Shape limits a checkpoint is allowed to ask for before anything is allocated
+constexpr uint32_t maxCheckpointLayers = 64;
+constexpr uint32_t maxCheckpointLayerWidth = 1u << 16;
+
+inline void writeNetworkCheckpoint(const std::string& path, const NeuralNetwork& network) {
+    NetworkCheckpointHeader h{};
+    std::memcpy(h.magic, networkCheckpointMagic, sizeof h.magic);
+    h.version = 1;
+    h.layerCount = static_cast<uint32_t>(network.layerSizes().size());
+    h.parameterCount = network.parameterCount();
+    std::vector<uint32_t> sizes(network.layerSizes().begin(), network.layerSizes().end());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("writeNetworkCheckpoint: cannot create " + path);
+    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    out.write(reinterpret_cast<const char*>(sizes.data()), sizes.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(network.parameters()), h.parameterCount * sizeof(double));
+    if (!out) throw std::runtime_error("writeNetworkCheckpoint: write failed for " + path);
+}
+
+inline NeuralNetwork readNetworkCheckpoint(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("readNetworkCheckpoint: cannot open " + path);
+    NetworkCheckpointHeader h{};
+    in.read(reinterpret_cast<char*>(&h), sizeof h);
+    if (!in || std::memcmp(h.magic, networkCheckpointMagic, sizeof h.magic) != 0 || h.version != 1 ||
+        h.layerCount < 2) {
+        throw std::runtime_error("readNetworkCheckpoint: not a network checkpoint: " + path);
+    }
+    if (h.layerCount > maxCheckpointLayers) {
+        throw std::runtime_error("readNetworkCheckpoint: too many layers in " + path);
+    }
+    std::vector<uint32_t> raw(h.layerCount);
+    in.read(reinterpret_cast<char*>(raw.data()), raw.size() * sizeof(uint32_t));
+    if (!in) throw std::runtime_error("readNetworkCheckpoint: truncated file " + path);
+
+    // Within the caps the count cannot overflow; it must match the header
+    // and the bytes left in the file before the network is allocated
+    uint64_t expected = 0;
+    for (size_t l = 0; l < raw.size(); ++l) {
+        if (raw[l] == 0 || raw[l] > maxCheckpointLayerWidth) {
+            throw std::runtime_error("readNetworkCheckpoint: invalid layer size in " + path);
+        }
+        if (l > 0) expected += (uint64_t(raw[l - 1]) + 1) * raw[l];
+    }
+    const std::streamoff paramsBegin = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streamoff fileEnd = in.tellg();
+    in.seekg(paramsBegin);
+    if (!in || expected != h.parameterCount ||
+        uint64_t(fileEnd - paramsBegin) != h.parameterCount * sizeof(double)) {
+        throw std::runtime_error("readNetworkCheckpoint: inconsistent header in " + path);
+    }
+
+    NeuralNetwork network(std::vector<int>(raw.begin(), raw.end()));
+    in.read(reinterpret_cast<char*>(network.parameters()), h.parameterCount * sizeof(double));
+    if (!in) throw std::runtime_error("readNetworkCheckpoint: truncated file " + path);
+    return network;
+}
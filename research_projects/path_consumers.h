@@ -0,0 +1,178 @@
+// Streaming path consumers for RoughBergomiEngine::stream
+// Each consumer keeps its per-path running state in a SIMD value, one path
+// per lane, updated as the time steps go by; only per-chunk totals live in
+// memory. PathConsumers runs several consumers over the same simulation.
+
+#pragma once
+
+#include "../common/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+// Sum, sum of squares and count of a per-path quantity
+struct PathStatistics {
+    double sum = 0.0;
+    double sumSq = 0.0;
+    size_t count = 0;
+
+    template <class V>
+    void add(V value, size_t lanes) {
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            double x = value.lane(static_cast<int>(lane));
+            sum += x;
+            sumSq += x * x;
+        }
+        count += lanes;
+    }
+
+    void merge(const PathStatistics& other) {
+        sum += other.sum;
+        sumSq += other.sumSq;
+        count += other.count;
+    }
+
+    double mean() const { return count ? sum / count : 0.0; }
+    double standardError() const {
+        if (count < 2) return 0.0;
+        double m = mean();
+        return std::sqrt(std::max(sumSq / count - m * m, 0.0) / (count - 1));
+    }
+};
+
+// Running maximum and minimum of the spot along each path
+struct RunningExtremes {
+    PathStatistics maximum, minimum;
+
+    template <class V>
+    struct State { V high, low; };
+
+    template <class V>
+    State<V> begin(V spot, V) const { return {spot, spot}; }
+
+    template <class V>
+    void step(State<V>& s, size_t, V spot, V) const {
+        s.high = simd::max(s.high, spot);
+        s.low = simd::min(s.low, spot);
+    }
+
+    template <class V>
+    void finish(const State<V>& s, size_t lanes) {
+        maximum.add(s.high, lanes);
+        minimum.add(s.low, lanes);
+    }
+
+    void merge(const RunningExtremes& other) {
+        maximum.merge(other.maximum);
+        minimum.merge(other.minimum);
+    }
+};
+
+// Arithmetic-average call on the spot at every simulated step after t = 0
+struct AsianCall {
+    double strike;
+    PathStatistics payoff;
+
+    explicit AsianCall(double K) : strike(K) {}
+
+    template <class V>
+    struct State { V sum; size_t steps; };
+
+    template <class V>
+    State<V> begin(V, V) const { return {V(0.0), 0}; }
+
+    template <class V>
+    void step(State<V>& s, size_t, V spot, V) const {
+        s.sum = s.sum + spot;
+        ++s.steps;
+    }
+
+    template <class V>
+    void finish(const State<V>& s, size_t lanes) {
+        V average = s.sum / V(static_cast<double>(s.steps));
+        payoff.add(simd::max(average - V(strike), V(0.0)), lanes);
+    }
+
+    void merge(const AsianCall& other) { payoff.merge(other.payoff); }
+};
+
+// Up-and-out call monitored at every simulated step
+struct UpAndOutCall {
+    double strike, barrier;
+    PathStatistics payoff, knockedOut;
+
+    UpAndOutCall(double K, double B) : strike(K), barrier(B) {}
+
+    template <class V>
+    struct State { V hit, spot; };
+
+    template <class V>
+    State<V> begin(V spot, V) const { return {simd::select(spot >= V(barrier), V(1.0), V(0.0)), spot}; }
+
+    template <class V>
+    void step(State<V>& s, size_t, V spot, V) const {
+        s.hit = simd::select(spot >= V(barrier), V(1.0), s.hit);
+        s.spot = spot;
+    }
+
+    template <class V>
+    void finish(const State<V>& s, size_t lanes) {
+        payoff.add((V(1.0) - s.hit) * simd::max(s.spot - V(strike), V(0.0)), lanes);
+        knockedOut.add(s.hit, lanes);
+    }
+
+    void merge(const UpAndOutCall& other) {
+        payoff.merge(other.payoff);
+        knockedOut.merge(other.knockedOut);
+    }
+};
+
+// Several consumers fed from one simulation
+template <class... Consumers>
+struct PathConsumers {
+    std::tuple<Consumers...> consumers;
+
+    explicit PathConsumers(Consumers... cs) : consumers(std::move(cs)...) {}
+
+    template <class V>
+    using State = std::tuple<typename Consumers::template State<V>...>;
+
+    template <size_t I>
+    const auto& get() const { return std::get<I>(consumers); }
+
+    template <class V>
+    State<V> begin(V spot, V variance) const {
+        return std::apply([&](const auto&... c) { return State<V>(c.begin(spot, variance)...); }, consumers);
+    }
+
+    template <class V>
+    void step(State<V>& s, size_t i, V spot, V variance) const {
+        stepAll(s, i, spot, variance, std::index_sequence_for<Consumers...>());
+    }
+
+    template <class V>
+    void finish(const State<V>& s, size_t lanes) {
+        finishAll(s, lanes, std::index_sequence_for<Consumers...>());
+    }
+
+    void merge(const PathConsumers& other) { mergeAll(other, std::index_sequence_for<Consumers...>()); }
+
+private:
+    template <class V, size_t... I>
+    void stepAll(State<V>& s, size_t i, V spot, V variance, std::index_sequence<I...>) const {
+        (std::get<I>(consumers).step(std::get<I>(s), i, spot, variance), ...);
+    }
+
+    template <class V, size_t... I>
+    void finishAll(const State<V>& s, size_t lanes, std::index_sequence<I...>) {
+        (std::get<I>(consumers).finish(std::get<I>(s), lanes), ...);
+    }
+
+    template <size_t... I>
+    void mergeAll(const PathConsumers& other, std::index_sequence<I...>) {
+        (std::get<I>(consumers).merge(std::get<I>(other.consumers)), ...);
+    }
+};
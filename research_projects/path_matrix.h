@@ -0,0 +1,29 @@
+// Preallocated paths x time matrix for simulated paths
+// One padded, cache-line aligned row of steps + 1 values per path, so each
+// path is contiguous for per-path kernels and rows never share a cache line.
+
+#pragma once
+
+#include "../common/aligned.h"
+
+#include <cstddef>
+
+class PathMatrix {
+private:
+    size_t pathCount = 0;
+    size_t stepCount = 0;
+    size_t rowStride = 0;
+    AlignedVector<double> data;
+
+public:
+    PathMatrix() = default;
+    PathMatrix(size_t paths, size_t steps)
+        : pathCount(paths), stepCount(steps), rowStride((steps + 1 + 7) / 8 * 8), data(paths * rowStride, 0.0) {}
+
+    size_t paths() const { return pathCount; }
+    size_t steps() const { return stepCount; }
+    size_t stride() const { return rowStride; }
+
+    double* path(size_t p) { return &data[p * rowStride]; }
+    const double* path(size_t p) const { return &data[p * rowStride]; }
+};
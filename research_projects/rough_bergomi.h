@@ -0,0 +1,325 @@
+// Rough Bergomi paths by the hybrid scheme (Bennedsen, Lunde & Pakkanen, 2017)
+//   v_t = xi0 exp(eta V_t - eta^2/2 t^2H),  V_t = sqrt(2H) int_0^t (t-s)^(H-1/2) dW_s
+//   dS_t / S_t = sqrt(v_t) (rho dW_t + sqrt(1 - rho^2) dW_t^perp)
+// The singular part of the kernel on the most recent step is simulated
+// exactly (kappa = 1); the rest is a discrete convolution of the Brownian
+// increments with optimally placed kernel weights, done by FFT in
+// O(n log n) instead of O(n^2). One complex transform convolves two paths.
+// Paths run in blocks across the pool, one Philox stream per pair of paths,
+// and are written into preallocated paths x steps matrices.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/fft.h"
+#include "../common/random.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+#include "path_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Unit-step hybrid-scheme quantities for (steps, H); the time step enters
+// only through powers of dt applied at simulation time
+class HybridKernel {
+private:
+    size_t stepCount;
+    double hurst;
+    FftPlan fft;
+    AlignedVector<double> spectrumRe, spectrumIm;   // FFT of the weights, scaled by 1/size
+    AlignedVector<double> halfPower;                // i^2H / 2 for the variance compensator
+    double exactCovariance;                         // Cov(dW, exact part) on a unit step
+    double exactResidual;                           // sqrt of the remaining exact-part variance
+
+public:
+    HybridKernel(size_t steps, double H) : stepCount(steps), hurst(H) {
+        if (steps == 0 || !(H > 0.0 && H < 0.5)) throw std::invalid_argument("HybridKernel: need steps > 0, 0 < H < 1/2");
+        const double alpha = H - 0.5;
+        size_t M = 1;
+        while (M < 2 * (steps + 1)) M *= 2;
+        fft = FftPlan(M);
+
+        // Weight on dW_{i-k+1} for k >= 2 is g(b*_k) = (k^(a+1) - (k-1)^(a+1)) / (a+1)
+        spectrumRe.assign(M, 0.0);
+        spectrumIm.assign(M, 0.0);
+        for (size_t k = 2; k <= steps; ++k) {
+            double kk = static_cast<double>(k);
+            spectrumRe[k] = (std::pow(kk, alpha + 1) - std::pow(kk - 1, alpha + 1)) / (alpha + 1);
+        }
+        fft.forward(spectrumRe.data(), spectrumIm.data());
+        for (size_t k = 0; k < M; ++k) {
+            spectrumRe[k] /= M;
+            spectrumIm[k] /= M;
+        }
+
+        halfPower.resize(steps + 1);
+        for (size_t i = 0; i <= steps; ++i) halfPower[i] = 0.5 * std::pow(static_cast<double>(i), 2 * H);
+
+        exactCovariance = 1.0 / (alpha + 1);
+        exactResidual = std::sqrt(1.0 / (2 * alpha + 1) - exactCovariance * exactCovariance);
+    }
+
+    size_t steps() const { return stepCount; }
+    double H() const { return hurst; }
+    const FftPlan& plan() const { return fft; }
+    const double* weightsRe() const { return spectrumRe.data(); }
+    const double* weightsIm() const { return spectrumIm.data(); }
+    const double* compensator() const { return halfPower.data(); }
+    double covariance() const { return exactCovariance; }
+    double residual() const { return exactResidual; }
+
+    // Shared, lazily built kernel for (steps, H). Calibration visits many H
+    // values, so the cache is dropped once it grows past a few hundred entries.
+    static std::shared_ptr<const HybridKernel> get(size_t steps, double H) {
+        static std::mutex mutex;
+        static std::map<std::pair<size_t, double>, std::shared_ptr<const HybridKernel>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cache.size() >= 256) cache.clear();
+        auto& entry = cache[{steps, H}];
+        if (!entry) entry = std::make_shared<const HybridKernel>(steps, H);
+        return entry;
+    }
+};
+
+struct RoughBergomiParameters {
+    double H;      // Hurst exponent, 0 < H < 1/2
+    double eta;    // volatility of volatility
+    double rho;    // spot-vol correlation
+    double xi0;    // flat forward variance
+};
+
+class RoughBergomiEngine {
+public:
+    static constexpr size_t blockPaths = 32;     // paths per parallel task
+    static constexpr size_t streamChunk = 1024;  // paths per consumer copy when streaming
+
+private:
+    RoughBergomiParameters params;
+    double T;
+    std::shared_ptr<const HybridKernel> kernel;
+    double dt, volterraScale, compensatorScale, rhoBar;
+
+    struct Scratch {
+        AlignedVector<double> normals, re, im, variance;
+        AlignedVector<double> spots, variances;   // group rows for streaming
+    };
+
+    template <class V>
+    static void multiplySpectrum(double* re, double* im, const double* kr, const double* ki, size_t i) {
+        V a = V::load(re + i), b = V::load(im + i), c = V::load(kr + i), d = V::load(ki + i);
+        simd::fma(a, c, -(b * d)).store(re + i);
+        simd::fma(a, d, b * c).store(im + i);
+    }
+
+    // Variance at t_1..t_n from the exact last-step term and the convolution
+    template <class V>
+    void varianceStep(double* var, const double* dW, const double* z, const double* conv, size_t i) const {
+        V exact = simd::fma(V(kernel->covariance()), V::load(dW + i - 1), V(kernel->residual()) * V::load(z + i - 1));
+        V volterra = V(volterraScale) * (exact + V::load(conv + i));
+        V x = volterra - V(compensatorScale) * V::load(kernel->compensator() + i);
+        (V(params.xi0) * simd::exp(x)).store(var + i);
+    }
+
+    // Log-price increment over step i from the variance at its start
+    template <class V>
+    void logIncrement(double* logS, const double* var, const double* dW, const double* perp, size_t i) const {
+        V v = V::load(var + i - 1);
+        V dZ = simd::fma(V(params.rho), V::load(dW + i - 1), V(rhoBar) * V::load(perp + i - 1));
+        simd::fma(simd::sqrt(v * V(dt)), dZ, V(-0.5 * dt) * v).store(logS + i);
+    }
+
+    template <class V>
+    static void exponentiate(double* row, double S0, size_t i) {
+        (V(S0) * simd::exp(V::load(row + i))).store(row + i);
+    }
+
+    // Variance and log(S / S0) rows for paths 2 * stream and 2 * stream + 1
+    // (count of them, 1 or 2), sharing one FFT convolution
+    void pairPaths(Scratch& s, uint64_t seed, uint64_t stream, size_t count,
+                   double* const* var, double* const* logS) const {
+        const size_t n = kernel->steps();
+        const size_t M = kernel->plan().size();
+
+        s.normals.resize(6 * n);
+        pairNormals(seed, stream, s.normals.data());
+
+        s.re.assign(M, 0.0);
+        s.im.assign(M, 0.0);
+        std::copy(s.normals.begin(), s.normals.begin() + n, s.re.begin());
+        std::copy(s.normals.begin() + 3 * n, s.normals.begin() + 4 * n, s.im.begin());
+        kernel->plan().forward(s.re.data(), s.im.data());
+        applyKernel(s.re.data(), s.im.data());
+
+        for (size_t j = 0; j < count; ++j) {
+            const double* z = &s.normals[3 * n * j];
+            buildLogPath(z, z + n, z + 2 * n, j == 0 ? s.re.data() : s.im.data(), var[j], logS[j]);
+        }
+    }
+
+    // S0 * exp(row) in place over steps 0..n
+    void exponentiateRow(double* row, double S0) const {
+        using V = simd::Native;
+        const size_t n = kernel->steps();
+        size_t i = 0;
+        for (; i + V::width <= n + 1; i += V::width) exponentiate<V>(row, S0, i);
+        for (; i <= n; ++i) exponentiate<simd::Scalar>(row, S0, i);
+    }
+
+    // Feed lanes [first, first + lanes) of the group rows to a consumer, one
+    // time step at a time with a path in each SIMD lane
+    template <class V, class Consumer>
+    void feed(Consumer& consumer, const Scratch& s, size_t first, size_t lanes, double S0) const {
+        const size_t n = kernel->steps();
+        const size_t stride = n + 1;
+        auto state = consumer.template begin<V>(V(S0), V(params.xi0));
+        alignas(64) double spot[V::width], var[V::width];
+        for (size_t i = 1; i <= n; ++i) {
+            for (int lane = 0; lane < V::width; ++lane) {
+                // Idle lanes repeat the first path; finish() ignores them
+                size_t row = first + (static_cast<size_t>(lane) < lanes ? lane : 0);
+                spot[lane] = s.spots[row * stride + i];
+                var[lane] = s.variances[row * stride + i];
+            }
+            consumer.step(state, i, V::load(spot), V::load(var));
+        }
+        consumer.finish(state, lanes);
+    }
+
+public:
+    RoughBergomiEngine(const RoughBergomiParameters& p, double maturity, size_t steps)
+        : params(p), T(maturity), kernel(HybridKernel::get(steps, p.H)), dt(maturity / steps),
+          volterraScale(p.eta * std::sqrt(2 * p.H) * std::pow(dt, p.H)),
+          compensatorScale(p.eta * p.eta * std::pow(dt, 2 * p.H)), rhoBar(std::sqrt(1.0 - p.rho * p.rho)) {}
+
+    size_t steps() const { return kernel->steps(); }
+    const HybridKernel& hybridKernel() const { return *kernel; }
+
+    // Unit normals for a pair of paths, 3 * steps per path: Brownian
+    // increments, exact-part residuals, orthogonal increments
+    void pairNormals(uint64_t seed, uint64_t stream, double* out) const {
+        Philox4x32 rng(seed, stream);
+        rng.fillNormal(out, 6 * kernel->steps());
+    }
+
+    // Given the FFT of two paths' increments in (re, im), leave their kernel
+    // convolutions in re and im (index i holds the sum up to step i)
+    void applyKernel(double* re, double* im) const {
+        using V = simd::Native;
+        const size_t M = kernel->plan().size();
+        size_t k = 0;
+        for (; k + V::width <= M; k += V::width) {
+            multiplySpectrum<V>(re, im, kernel->weightsRe(), kernel->weightsIm(), k);
+        }
+        for (; k < M; ++k) {
+            multiplySpectrum<simd::Scalar>(re, im, kernel->weightsRe(), kernel->weightsIm(), k);
+        }
+        kernel->plan().inverse(re, im);
+    }
+
+    // Variance and log(S / S0) rows for one path from its unit normals and
+    // convolution; unit-step increments are scaled by sqrt(dt) here
+    void buildLogPath(const double* dW, const double* residual, const double* perp, const double* conv,
+                      double* var, double* logS) const {
+        using V = simd::Native;
+        const size_t n = kernel->steps();
+        var[0] = params.xi0;
+        size_t i = 1;
+        for (; i + V::width <= n + 1; i += V::width) varianceStep<V>(var, dW, residual, conv, i);
+        for (; i <= n; ++i) varianceStep<simd::Scalar>(var, dW, residual, conv, i);
+
+        logS[0] = 0.0;
+        for (i = 1; i + V::width <= n + 1; i += V::width) logIncrement<V>(logS, var, dW, perp, i);
+        for (; i <= n; ++i) logIncrement<simd::Scalar>(logS, var, dW, perp, i);
+        for (i = 1; i <= n; ++i) logS[i] += logS[i - 1];
+    }
+
+    // Fill spot (and variance, when given) for paths [firstPath, firstPath + spot.paths()).
+    // firstPath must be even; pair k of the global numbering uses Philox stream k.
+    void simulate(PathMatrix& spot, PathMatrix* variance, double S0, uint64_t seed, uint64_t firstPath = 0,
+                  ThreadPool& pool = defaultThreadPool()) const {
+        const size_t n = kernel->steps();
+        if (spot.steps() != n || (variance && (variance->steps() != n || variance->paths() != spot.paths()))) {
+            throw std::invalid_argument("RoughBergomiEngine: path matrix shape mismatch");
+        }
+        if (firstPath % 2 != 0) throw std::invalid_argument("RoughBergomiEngine: firstPath must be even");
+        const size_t paths = spot.paths();
+        const size_t blocks = (paths + blockPaths - 1) / blockPaths;
+
+        pool.parallelFor(blocks, [&](size_t block) {
+            thread_local Scratch scratch;
+            scratch.variance.resize(2 * (n + 1));
+            const size_t last = std::min(paths, (block + 1) * blockPaths);
+            for (size_t row = block * blockPaths; row < last; row += 2) {
+                const size_t count = std::min<size_t>(2, last - row);
+                double* var[2], *logS[2];
+                for (size_t j = 0; j < 2; ++j) {
+                    bool stored = variance && j < count;
+                    var[j] = stored ? variance->path(row + j) : &scratch.variance[j * (n + 1)];
+                    logS[j] = spot.path(row + std::min(j, count - 1));
+                }
+                pairPaths(scratch, seed, (firstPath + row) / 2, count, var, logS);
+                for (size_t j = 0; j < count; ++j) exponentiateRow(spot.path(row + j), S0);
+            }
+        });
+    }
+
+    // Per-thread working memory of stream(), in bytes
+    size_t streamScratchBytes() const {
+        const size_t group = simd::Native::width < 2 ? 2 : simd::Native::width;
+        const size_t n = kernel->steps();
+        return sizeof(double) * (6 * n + 2 * kernel->plan().size() + 2 * group * (n + 1));
+    }
+
+    // Stream paths [0, paths) through a consumer instead of storing them.
+    // Working memory is a few rows per thread, independent of the path count;
+    // paths match simulate() with the same seed. Each chunk of paths feeds its
+    // own copy of prototype and the copies are merged in chunk order.
+    // A consumer provides
+    //   template <class V> struct State;                      per-lane running state
+    //   template <class V> State<V> begin(V spot, V variance);
+    //   template <class V> void step(State<V>&, size_t i, V spot, V variance);
+    //   template <class V> void finish(const State<V>&, size_t lanes);
+    //   void merge(const Consumer&);
+    template <class Consumer>
+    Consumer stream(size_t paths, double S0, uint64_t seed, const Consumer& prototype,
+                    ThreadPool& pool = defaultThreadPool()) const {
+        using V = simd::Native;
+        constexpr size_t group = V::width < 2 ? 2 : V::width;   // whole pairs of paths
+        const size_t n = kernel->steps();
+        const size_t chunks = (paths + streamChunk - 1) / streamChunk;
+        std::vector<Consumer> partial(chunks, prototype);
+
+        pool.parallelFor(chunks, [&](size_t chunk) {
+            thread_local Scratch scratch;
+            scratch.spots.resize(group * (n + 1));
+            scratch.variances.resize(group * (n + 1));
+            Consumer& consumer = partial[chunk];
+            const size_t last = std::min(paths, (chunk + 1) * streamChunk);
+
+            for (size_t base = chunk * streamChunk; base < last; base += group) {
+                const size_t count = std::min(group, last - base);
+                for (size_t j = 0; j < count; j += 2) {
+                    double* var[2] = {&scratch.variances[j * (n + 1)], &scratch.variances[(j + 1) * (n + 1)]};
+                    double* logS[2] = {&scratch.spots[j * (n + 1)], &scratch.spots[(j + 1) * (n + 1)]};
+                    pairPaths(scratch, seed, (base + j) / 2, std::min<size_t>(2, count - j), var, logS);
+                }
+                for (size_t j = 0; j < count; ++j) exponentiateRow(&scratch.spots[j * (n + 1)], S0);
+                for (size_t first = 0; first < count; first += V::width) {
+                    feed<V>(consumer, scratch, first, std::min<size_t>(V::width, count - first), S0);
+                }
+            }
+        });
+
+        Consumer total = prototype;
+        for (const auto& c : partial) total.merge(c);
+        return total;
+    }
+};
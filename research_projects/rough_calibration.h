@@ -0,0 +1,324 @@
+// Rough Bergomi calibration to an implied-volatility surface
+// Common random numbers: the normals and the FFT of every pair's Brownian
+// increments are drawn once, so the Monte Carlo surface is a smooth function
+// of the parameters. Kernel convolutions depend only on H and are recomputed
+// (one inverse FFT per pair of paths) only when H moves; changes to eta, rho
+// and xi0 just rebuild the paths. Paths are priced in parallel blocks into
+// preallocated partial sums, reduced in block order. The fit is
+// Levenberg-Marquardt on vega-weighted price errors, which approximate
+// implied-vol errors without inverting every trial surface.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+#include "../projects/option-pricer/implied_vol.h"
+#include "path_matrix.h"
+#include "rough_bergomi.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Call quotes on a maturity x strike grid (zero rates), row-major by maturity
+struct SmileSurface {
+    double spot = 100.0;
+    std::vector<double> maturities;          // ascending
+    size_t strikesPerMaturity = 0;
+    std::vector<double> strike;              // maturities.size() * strikesPerMaturity
+    std::vector<double> impliedVol;          // same shape; empty for a pricing grid
+
+    size_t size() const { return strike.size(); }
+    double maturity(size_t quote) const { return maturities[quote / strikesPerMaturity]; }
+};
+
+struct CalibrationSettings {
+    size_t paths = 16384;
+    size_t stepsPerYear = 100;
+    uint64_t seed = 7;
+    int maxIterations = 25;
+    double tolerance = 1e-6;    // relative objective decrease that ends the fit
+};
+
+struct CalibrationResult {
+    RoughBergomiParameters params;
+    double volRmse;             // root mean square implied-vol error
+    int iterations;
+    int evaluations;            // full surface repricings
+    std::vector<double> modelVols;
+};
+
+class RoughBergomiSurfacePricer {
+private:
+    SmileSurface grid;
+    CalibrationSettings settings;
+    ThreadPool* pool;
+
+    size_t steps = 0;
+    double horizon = 0.0;
+    size_t fftSize = 0;
+    std::vector<size_t> maturityStep;
+
+    AlignedVector<double> normals;      // 6 * steps per pair of paths
+    AlignedVector<double> spectra;      // FFT of each pair's increments, re then im
+    PathMatrix convolution;             // kernel convolution per path for convolutionH
+    double convolutionH = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> partial;        // per-block payoff, in-the-money and spot sums
+    int evaluationCount = 0;
+
+    size_t partialStride() const { return 2 * grid.size() + grid.maturities.size(); }
+    size_t blocks() const { return (settings.paths + RoughBergomiEngine::blockPaths - 1) / RoughBergomiEngine::blockPaths; }
+
+    void updateConvolutions(const RoughBergomiEngine& engine) {
+        const size_t pairs = settings.paths / 2;
+        pool->parallelFor(pairs, [&](size_t pair) {
+            thread_local AlignedVector<double> re, im;
+            re.resize(fftSize);
+            im.resize(fftSize);
+            const double* spectrum = &spectra[2 * fftSize * pair];
+            std::copy(spectrum, spectrum + fftSize, re.begin());
+            std::copy(spectrum + fftSize, spectrum + 2 * fftSize, im.begin());
+            engine.applyKernel(re.data(), im.data());
+            std::copy(re.begin(), re.begin() + steps + 1, convolution.path(2 * pair));
+            std::copy(im.begin(), im.begin() + steps + 1, convolution.path(2 * pair + 1));
+        });
+    }
+
+public:
+    RoughBergomiSurfacePricer(const SmileSurface& surface, const CalibrationSettings& s = CalibrationSettings(),
+                              ThreadPool& threads = defaultThreadPool())
+        : grid(surface), settings(s), pool(&threads) {
+        if (grid.maturities.empty() || grid.strikesPerMaturity == 0 ||
+            grid.strike.size() != grid.maturities.size() * grid.strikesPerMaturity) {
+            throw std::invalid_argument("RoughBergomiSurfacePricer: malformed surface");
+        }
+        settings.paths = (settings.paths + 1) / 2 * 2;
+        horizon = grid.maturities.back();
+        steps = std::max<size_t>(1, static_cast<size_t>(std::lround(horizon * settings.stepsPerYear)));
+        for (double T : grid.maturities) {
+            maturityStep.push_back(std::max<size_t>(1, static_cast<size_t>(std::lround(T / horizon * steps))));
+        }
+
+        // Draw once: the same numbers serve every parameter set
+        RoughBergomiEngine engine({0.1, 1.0, 0.0, 0.04}, horizon, steps);
+        fftSize = engine.hybridKernel().plan().size();
+        const size_t pairs = settings.paths / 2;
+        normals.resize(6 * steps * pairs);
+        spectra.assign(2 * fftSize * pairs, 0.0);
+        convolution = PathMatrix(settings.paths, steps);
+        partial.resize(blocks() * partialStride());
+
+        pool->parallelFor(pairs, [&](size_t pair) {
+            double* z = &normals[6 * steps * pair];
+            engine.pairNormals(settings.seed, pair, z);
+            double* re = &spectra[2 * fftSize * pair];
+            double* im = re + fftSize;
+            std::copy(z, z + steps, re);
+            std::copy(z + 3 * steps, z + 4 * steps, im);
+            engine.hybridKernel().plan().forward(re, im);
+        });
+    }
+
+    const SmileSurface& surface() const { return grid; }
+    int evaluations() const { return evaluationCount; }
+
+    // Monte Carlo call prices for every quote; prices must have surface().size()
+    // entries. The discounted spot is a control variate with the in-the-money
+    // fraction as coefficient, C = E[(S - K)+] - P(S > K) (E[S] - S0).
+    void priceSurface(const RoughBergomiParameters& params, std::vector<double>& prices) {
+        using V = simd::Native;
+        RoughBergomiEngine engine(params, horizon, steps);
+        if (!(params.H == convolutionH)) {
+            updateConvolutions(engine);
+            convolutionH = params.H;
+        }
+        ++evaluationCount;
+
+        const size_t quotes = grid.size();
+        const size_t K = grid.strikesPerMaturity;
+        const size_t stride = partialStride();
+        pool->parallelFor(blocks(), [&](size_t block) {
+            thread_local AlignedVector<double> var, logS;
+            var.resize(steps + 1);
+            logS.resize(steps + 1);
+            double* sums = &partial[block * stride];
+            double* inTheMoney = sums + quotes;
+            double* spotSums = sums + 2 * quotes;
+            std::fill(sums, sums + stride, 0.0);
+
+            const size_t first = block * RoughBergomiEngine::blockPaths;
+            const size_t last = std::min(settings.paths, first + RoughBergomiEngine::blockPaths);
+            for (size_t p = first; p < last; ++p) {
+                const double* z = &normals[6 * steps * (p / 2) + 3 * steps * (p % 2)];
+                engine.buildLogPath(z, z + steps, z + 2 * steps, convolution.path(p), var.data(), logS.data());
+                for (size_t m = 0; m < maturityStep.size(); ++m) {
+                    const double ST = grid.spot * std::exp(logS[maturityStep[m]]);
+                    const double* strikes = &grid.strike[m * K];
+                    double* out = sums + m * K;
+                    double* itm = inTheMoney + m * K;
+                    spotSums[m] += ST;
+                    size_t k = 0;
+                    for (; k + V::width <= K; k += V::width) {
+                        V intrinsic = V(ST) - V::load(strikes + k);
+                        (V::load(out + k) + simd::max(intrinsic, V(0.0))).store(out + k);
+                        (V::load(itm + k) + simd::select(intrinsic > V(0.0), V(1.0), V(0.0))).store(itm + k);
+                    }
+                    for (; k < K; ++k) {
+                        out[k] += std::max(ST - strikes[k], 0.0);
+                        itm[k] += ST > strikes[k] ? 1.0 : 0.0;
+                    }
+                }
+            }
+        });
+
+        const double scale = 1.0 / settings.paths;
+        for (size_t q = 0; q < quotes; ++q) {
+            double payoff = 0.0, itm = 0.0, spot = 0.0;
+            for (size_t b = 0; b < blocks(); ++b) {
+                payoff += partial[b * stride + q];
+                itm += partial[b * stride + quotes + q];
+                spot += partial[b * stride + 2 * quotes + q / K];
+            }
+            prices[q] = scale * payoff - scale * itm * (scale * spot - grid.spot);
+        }
+    }
+
+    // Implied vols of the Monte Carlo prices (NaN where a price is out of bounds)
+    std::vector<double> impliedVols(const RoughBergomiParameters& params) {
+        std::vector<double> prices(grid.size());
+        priceSurface(params, prices);
+        CallQuoteBatch quotes;
+        for (size_t q = 0; q < grid.size(); ++q) quotes.add(prices[q], grid.spot, grid.strike[q], grid.maturity(q), 0.0);
+        ImpliedVolResult result;
+        solveImpliedVol(quotes, result);
+        return result.volatility;
+    }
+};
+
+// Levenberg-Marquardt fit of (H, eta, rho, xi0) to surface.impliedVol with a
+// forward-difference Jacobian. Bumps in eta, rho and xi0 reuse the cached
+// convolutions; all buffers are sized once before the loop.
+inline CalibrationResult calibrateRoughBergomi(RoughBergomiSurfacePricer& pricer, const RoughBergomiParameters& initial,
+                                               const CalibrationSettings& settings = CalibrationSettings()) {
+    const SmileSurface& s = pricer.surface();
+    const size_t R = s.size();
+    if (s.impliedVol.size() != R) throw std::invalid_argument("calibrateRoughBergomi: surface has no implied vols");
+    constexpr size_t P = 4;
+    using Vector = std::array<double, P>;
+    const Vector lower = {0.02, 0.1, -0.99, 1e-4};
+    const Vector upper = {0.45, 5.0, 0.99, 1.0};
+    const Vector bump = {0.01, 0.02, 0.01, 0.002};
+
+    // Market prices and vegas, zero rates
+    std::vector<double> market(R), weight(R);
+    for (size_t q = 0; q < R; ++q) {
+        const double T = s.maturity(q), sigma = s.impliedVol[q], sqrtT = std::sqrt(T);
+        const double d1 = std::log(s.spot / s.strike[q]) / (sigma * sqrtT) + 0.5 * sigma * sqrtT;
+        const double d2 = d1 - sigma * sqrtT;
+        market[q] = s.spot * simd::normCdf(simd::Scalar(d1)).v - s.strike[q] * simd::normCdf(simd::Scalar(d2)).v;
+        const double vega = s.spot * simd::normPdf(simd::Scalar(d1)).v * sqrtT;
+        weight[q] = 1.0 / std::max(vega, 1e-3 * s.spot * sqrtT);
+    }
+
+    auto toParams = [](const Vector& x) { return RoughBergomiParameters{x[0], x[1], x[2], x[3]}; };
+    std::vector<double> prices(R), residual(R), trial(R), jacobian(R * P);
+    auto evaluate = [&](const Vector& x, std::vector<double>& r) {
+        pricer.priceSurface(toParams(x), prices);
+        double sum = 0.0;
+        for (size_t q = 0; q < R; ++q) {
+            r[q] = (prices[q] - market[q]) * weight[q];
+            sum += r[q] * r[q];
+        }
+        return sum;
+    };
+
+    const int startEvaluations = pricer.evaluations();
+    Vector x = {initial.H, initial.eta, initial.rho, initial.xi0};
+    for (size_t p = 0; p < P; ++p) x[p] = std::min(std::max(x[p], lower[p]), upper[p]);
+    double objective = evaluate(x, residual);
+    double damping = 1e-3;
+    int iteration = 0;
+
+    while (iteration < settings.maxIterations) {
+        ++iteration;
+        // Bump H last so the cached convolutions serve the other three columns
+        for (size_t p : {size_t(1), size_t(2), size_t(3), size_t(0)}) {
+            Vector xb = x;
+            double h = xb[p] + bump[p] <= upper[p] ? bump[p] : -bump[p];
+            xb[p] += h;
+            evaluate(xb, trial);
+            for (size_t q = 0; q < R; ++q) jacobian[q * P + p] = (trial[q] - residual[q]) / h;
+        }
+
+        double A[P][P] = {}, g[P] = {};
+        for (size_t q = 0; q < R; ++q) {
+            const double* J = &jacobian[q * P];
+            for (size_t a = 0; a < P; ++a) {
+                g[a] += J[a] * residual[q];
+                for (size_t b = 0; b < P; ++b) A[a][b] += J[a] * J[b];
+            }
+        }
+
+        bool improved = false;
+        double decrease = 0.0;
+        for (int attempt = 0; attempt < 10 && !improved; ++attempt) {
+            // Solve (A + damping diag A) dx = -g by Gaussian elimination
+            double M[P][P + 1];
+            for (size_t a = 0; a < P; ++a) {
+                for (size_t b = 0; b < P; ++b) M[a][b] = A[a][b] + (a == b ? damping * A[a][a] + 1e-12 : 0.0);
+                M[a][P] = -g[a];
+            }
+            for (size_t c = 0; c < P; ++c) {
+                size_t pivot = c;
+                for (size_t r = c + 1; r < P; ++r) if (std::abs(M[r][c]) > std::abs(M[pivot][c])) pivot = r;
+                for (size_t k = 0; k <= P; ++k) std::swap(M[c][k], M[pivot][k]);
+                for (size_t r = c + 1; r < P; ++r) {
+                    double f = M[r][c] / M[c][c];
+                    for (size_t k = c; k <= P; ++k) M[r][k] -= f * M[c][k];
+                }
+            }
+            Vector step{};
+            for (size_t c = P; c-- > 0;) {
+                double v = M[c][P];
+                for (size_t k = c + 1; k < P; ++k) v -= M[c][k] * step[k];
+                step[c] = v / M[c][c];
+            }
+
+            Vector candidate;
+            for (size_t p = 0; p < P; ++p) candidate[p] = std::min(std::max(x[p] + step[p], lower[p]), upper[p]);
+            double value = evaluate(candidate, trial);
+            if (value < objective) {
+                decrease = (objective - value) / objective;
+                x = candidate;
+                objective = value;
+                residual.swap(trial);
+                damping = std::max(damping / 3.0, 1e-7);
+                improved = true;
+            } else {
+                damping *= 4.0;
+            }
+        }
+        if (!improved || decrease < settings.tolerance) break;
+    }
+
+    CalibrationResult result;
+    result.params = toParams(x);
+    result.modelVols = pricer.impliedVols(result.params);
+    double sum = 0.0;
+    size_t counted = 0;
+    for (size_t q = 0; q < R; ++q) {
+        if (std::isnan(result.modelVols[q])) continue;
+        double e = result.modelVols[q] - s.impliedVol[q];
+        sum += e * e;
+        ++counted;
+    }
+    result.volRmse = counted ? std::sqrt(sum / counted) : std::numeric_limits<double>::quiet_NaN();
+    result.iterations = iteration;
+    result.evaluations = pricer.evaluations() - startEvaluations;
+    return result;
+}
@@ -3,71 +3,203 @@
 
 #include <iostream>
 #include <vector>
-#include <random>
 #include <cmath>
+#include <chrono>
+#include <limits>
+#include <string>
 
-class RoughVolatilityModel {
-private:
-    double H;           // Hurst parameter (typically 0.1 for rough volatility)
-    double xi;          // Volatility of volatility
-    double rho;         // Correlation between price and volatility
-    double v0;          // Initial variance
-    
-public:
-    RoughVolatilityModel(double hurst, double vol_of_vol, double correlation, double initial_var)
-        : H(hurst), xi(vol_of_vol), rho(correlation), v0(initial_var) {}
+#include "../common/aligned.h"
+#include "../common/quasi_random.h"
+#include "../common/random.h"
+#include "../common/thread_pool.h"
+#include "path_consumers.h"
+#include "rough_volatility.h"
+
+// Throughput in batches of contiguous paths, plus a check of the exact
+// covariance: Var B_H(T) = T^2H and lag-1 increment correlation 2^(2H-1) - 1
+void benchmarkFbm(size_t paths, size_t steps, double H) {
+    const size_t batchSize = 4096;
+    const double T = 1.0;
+    RoughVolatilityModel model(H, 0.3, -0.7, 0.04);
+    PathMatrix batch(std::min(paths, batchSize), steps);
     
-    // Fractional Brownian Motion generator
-    std::vector<double> generateFBM(int n, double T) {
-        std::vector<double> fbm(n + 1, 0.0);
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::normal_distribution<> normal(0.0, 1.0);
-        
-        double dt = T / n;
-        
-        for (int i = 1; i <= n; ++i) {
-            fbm[i] = fbm[i-1] + std::sqrt(dt) * std::pow(dt, H - 0.5) * normal(gen);
+    double sumSq = 0.0, incSq = 0.0, incLag = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < paths; first += batchSize) {
+        if (paths - first < batch.paths()) batch = PathMatrix(paths - first, steps);
+        model.generateFBM(batch, T, first);
+        for (size_t p = 0; p < batch.paths(); ++p) {
+            const double* b = batch.path(p);
+            sumSq += b[steps] * b[steps];
+            double d1 = b[1] - b[0], d2 = b[2] - b[1];
+            incSq += d1 * d1;
+            incLag += d1 * d2;
         }
-        
-        return fbm;
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "\nDavies-Harte fBM Benchmark (" << paths << " paths x " << steps << " steps, H = " << H
+              << ", " << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Time: " << seconds << " s (" << paths / seconds << " paths/s)\n";
+    std::cout << "Var B_H(T): " << sumSq / paths << " (exact " << std::pow(T, 2 * H) << ")\n";
+    std::cout << "Lag-1 increment correlation: " << incLag / incSq
+              << " (exact " << std::pow(2.0, 2 * H - 1) - 1 << ")\n";
+}
+
+// Hybrid-scheme throughput at increasing thread counts, plus martingale and
+// ATM price checks (the paths are identical for every thread count)
+void benchmarkRoughBergomi(size_t paths, size_t steps) {
+    const double T = 1.0, S0 = 100.0;
+    RoughVolatilityModel model(0.1, 1.9, -0.9, 0.04);
+    PathMatrix spot(paths, steps);
+    
+    std::cout << "\nRough Bergomi Hybrid Scheme Benchmark (" << paths << " paths x " << steps << " steps, "
+              << simd::nativeName() << ")\n";
+    std::vector<size_t> threadCounts;
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t t = 1; t < hardware; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(hardware);
+    
+    double baseline = 0.0;
+    for (size_t threads : threadCounts) {
+        ThreadPool pool(threads);
+        auto start = std::chrono::steady_clock::now();
+        model.simulateRoughBergomi(spot, nullptr, T, S0, 0, pool);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1) baseline = seconds;
+        std::cout << threads << " threads: " << seconds << " s (" << paths / seconds << " paths/s, speedup "
+                  << baseline / seconds << "x)\n";
+    }
+    
+    double mean = 0.0, call = 0.0;
+    for (size_t p = 0; p < paths; ++p) {
+        double ST = spot.path(p)[steps];
+        mean += ST;
+        call += std::max(ST - S0, 0.0);
+    }
+    std::cout << "E[S_T] / S0: " << mean / paths / S0 << " (martingale: 1)\n";
+    std::cout << "ATM call: " << call / paths << "\n";
+}
+
+// Running extremes, an Asian call and an up-and-out call from one streamed
+// simulation, against the memory a stored paths x steps matrix would need
+void benchmarkStreaming(size_t paths, size_t steps) {
+    const double T = 1.0, S0 = 100.0;
+    RoughVolatilityModel model(0.1, 1.9, -0.9, 0.04);
+    PathConsumers<RunningExtremes, AsianCall, UpAndOutCall> consumers(RunningExtremes(), AsianCall(S0),
+                                                                      UpAndOutCall(S0, 120.0));
+    
+    auto start = std::chrono::steady_clock::now();
+    auto result = model.streamRoughBergomi(paths, steps, T, S0, consumers);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     
-    // Rough Heston simulation
-    std::pair<std::vector<double>, std::vector<double>> simulateRoughHeston(int n, double T, double S0) {
-        std::vector<double> prices(n + 1);
-        std::vector<double> variances(n + 1);
-        
-        prices[0] = S0;
-        variances[0] = v0;
-        
-        auto fbm = generateFBM(n, T);
-        
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::normal_distribution<> normal(0.0, 1.0);
-        
-        double dt = T / n;
-        
-        for (int i = 1; i <= n; ++i) {
-            double dW1 = normal(gen) * std::sqrt(dt);
-            double dW2 = rho * dW1 + std::sqrt(1 - rho*rho) * normal(gen) * std::sqrt(dt);
-            
-            // Rough variance process
-            double dBH = fbm[i] - fbm[i-1];
-            variances[i] = variances[i-1] + xi * std::sqrt(variances[i-1]) * dBH;
-            variances[i] = std::max(variances[i], 0.001);
-            
-            // Price process
-            prices[i] = prices[i-1] * std::exp(-0.5 * variances[i-1] * dt + 
-                                              std::sqrt(variances[i-1]) * dW1);
+    const auto& extremes = result.get<0>();
+    const auto& asian = result.get<1>();
+    const auto& barrier = result.get<2>();
+    std::cout << "\nStreaming Path Consumers (" << paths << " paths x " << steps << " steps, "
+              << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Time: " << seconds << " s (" << paths / seconds << " paths/s)\n";
+    RoughBergomiEngine engine({0.1, 1.9, -0.9, 0.04}, T, steps);
+    std::cout << "Working memory: " << engine.streamScratchBytes() / 1024 << " KB per thread vs "
+              << 8.0 * paths * (steps + 1) / (1 << 20) << " MB for a stored spot matrix\n";
+    std::cout << "E[max S]: " << extremes.maximum.mean() << ", E[min S]: " << extremes.minimum.mean() << "\n";
+    std::cout << "Asian ATM call: " << asian.payoff.mean() << " +/- " << asian.payoff.standardError() << "\n";
+    std::cout << "Up-and-out call (B = 120): " << barrier.payoff.mean() << " +/- " << barrier.payoff.standardError()
+              << ", knock-out probability " << barrier.knockedOut.mean() << "\n";
+}
+
+// Calibration to a 10 x 20 surface generated from known parameters with an
+// independent, larger simulation
+void benchmarkCalibration() {
+    const RoughBergomiParameters truth = {0.1, 1.9, -0.9, 0.04};
+    SmileSurface surface;
+    surface.strikesPerMaturity = 20;
+    for (int m = 1; m <= 10; ++m) {
+        double T = 0.2 * m;
+        surface.maturities.push_back(T);
+        for (size_t k = 0; k < surface.strikesPerMaturity; ++k) {
+            double logMoneyness = -0.4 + 0.6 * k / (surface.strikesPerMaturity - 1);
+            surface.strike.push_back(surface.spot * std::exp(logMoneyness * std::sqrt(T)));
         }
-        
-        return {prices, variances};
     }
-};
+    CalibrationSettings marketSettings;
+    marketSettings.paths = 32768;
+    marketSettings.seed = 99;
+    surface.impliedVol = RoughBergomiSurfacePricer(surface, marketSettings).impliedVols(truth);
+    
+    RoughVolatilityModel model(0.25, 1.0, -0.5, 0.06);
+    auto start = std::chrono::steady_clock::now();
+    CalibrationResult result = model.calibrate(surface);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "\nRough Bergomi Calibration Benchmark (10 x 20 surface, " << CalibrationSettings().paths
+              << " paths, " << defaultThreadPool().size() << " threads)\n";
+    std::cout << "Time: " << seconds << " s (" << result.iterations << " iterations, " << result.evaluations
+              << " surface evaluations, " << 1e3 * seconds / result.evaluations << " ms each)\n";
+    std::cout << "Fitted H " << result.params.H << ", eta " << result.params.eta << ", rho " << result.params.rho
+              << ", xi0 " << result.params.xi0 << " (true " << truth.H << ", " << truth.eta << ", " << truth.rho
+              << ", " << truth.xi0 << ")\n";
+    std::cout << "Implied vol RMSE: " << 1e4 * result.volRmse << " bp\n";
+}
+
+// Generator throughput in million numbers per second on one core, in blocks
+// of 4096 as the simulators draw them, then bulk normals on every pool thread
+// with one Philox stream per chunk
+void benchmarkNormals(size_t count = size_t(1) << 25) {
+    const size_t block = 4096, dims = 16, steps = 64;
+    AlignedVector<double> z(block), out(block);
+    double sink = 0.0;
+    auto rate = [&](auto&& fill) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t done = 0; done < count; done += block) {
+            fill();
+            sink += out[done / block % block];
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return count / seconds / 1e6;
+    };
 
-int main() {
+    Philox4x32 rng(7);
+    SobolSequence sobol(dims);
+    BrownianBridge bridge(steps);
+    rng.fillNormal(z.data(), block);
+    const double scalarNormal = rate([&] {
+        for (double& x : out) x = rng.normal();
+    });
+    const double bulkNormal = rate([&] { rng.fillNormal(out.data(), block); });
+    const double bulkUniform = rate([&] { rng.fillUniform(out.data(), block); });
+    const double quasiNormal = rate([&] {
+        for (size_t i = 0; i < block; i += dims) sobol.next(&out[i]);
+        inverseNormalCdf(out.data(), out.data(), block);
+    });
+    const double bridged = rate([&] { bridge.build(z.data(), out.data(), block / steps); });
+
+    ThreadPool& pool = defaultThreadPool();
+    const size_t chunks = 64 * pool.size(), perChunk = count / chunks / block * block;
+    std::vector<double> chunkSink(chunks);
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(chunks, [&](size_t c) {
+        thread_local AlignedVector<double> buffer(block);
+        Philox4x32 stream(7, c);
+        for (size_t done = 0; done < perChunk; done += block) {
+            stream.fillNormal(buffer.data(), block);
+            chunkSink[c] += buffer[0];
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (double x : chunkSink) sink += x;
+
+    std::cout << "\nRandom Number Benchmark (" << simd::nativeName() << ", M/s per core)\n";
+    std::cout << "Philox normal():         " << scalarNormal << "\n";
+    std::cout << "Philox fillNormal:       " << bulkNormal << "\n";
+    std::cout << "Philox fillUniform:      " << bulkUniform << "\n";
+    std::cout << "Sobol + inverse CDF:     " << quasiNormal << " (" << dims << " dimensions)\n";
+    std::cout << "Brownian bridge:         " << bridged << " increments (" << steps << " steps)\n";
+    std::cout << "fillNormal, " << pool.size() << " threads: " << chunks * perChunk / seconds / 1e6 << " total ("
+              << chunks * perChunk / seconds / 1e6 / pool.size() << " per thread, checksum " << sink << ")\n";
+}
+
+int main(int argc, char** argv) {
     RoughVolatilityModel model(0.1, 0.3, -0.7, 0.04);
     
     std::cout << "Rough Volatility Model (Gatheral et al. 2018)\n";
@@ -78,5 +210,13 @@ int main() {
     std::cout << "Final price: $" << prices.back() << std::endl;
     std::cout << "Final variance: " << variances.back() << std::endl;
     
+    size_t benchPaths = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t benchSteps = argc > 2 ? std::stoul(argv[2]) : 1000;
+    benchmarkFbm(benchPaths, benchSteps, 0.1);
+    benchmarkRoughBergomi(argc > 3 ? std::stoul(argv[3]) : 20000, benchSteps);
+    benchmarkStreaming(argc > 4 ? std::stoul(argv[4]) : 100000, 252);
+    benchmarkCalibration();
+    benchmarkNormals();
+    
     return 0;
 }
\ No newline at end of file
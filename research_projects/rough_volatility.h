@@ -0,0 +1,111 @@
+// Rough volatility model (Gatheral, Jaisson & Rosenbaum 2018)
+// One parameter set (H, vol-of-vol, correlation, initial variance) behind
+// Davies-Harte fBM, hybrid-scheme rough Bergomi paths (stored or streamed
+// through a consumer), smile calibration and a rough Heston-style path;
+// every draw is reproducible from the seed.
+
+#pragma once
+
+#include "../common/random.h"
+#include "../common/thread_pool.h"
+#include "fractional_brownian_motion.h"
+#include "path_matrix.h"
+#include "rough_bergomi.h"
+#include "rough_calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+class RoughVolatilityModel {
+private:
+    double H;           // Hurst parameter (typically 0.1 for rough volatility)
+    double xi;          // Volatility of volatility
+    double rho;         // Correlation between price and volatility
+    double v0;          // Initial variance
+    
+    uint64_t seed;      // All draws are reproducible from this seed
+    uint64_t fbmPairsDrawn = 0;
+    Philox4x32 rng;
+    
+public:
+    RoughVolatilityModel(double hurst, double vol_of_vol, double correlation, double initial_var,
+                         uint64_t seed = 2018)
+        : H(hurst), xi(vol_of_vol), rho(correlation), v0(initial_var), seed(seed),
+          rng(seed, std::numeric_limits<uint64_t>::max()) {}
+    
+    // Exact fractional Brownian motion on n steps (Davies-Harte)
+    std::vector<double> generateFBM(int n, double T) {
+        PathMatrix batch(1, n);
+        generateFbm(batch, H, T, seed, 2 * fbmPairsDrawn++);
+        return std::vector<double>(batch.path(0), batch.path(0) + n + 1);
+    }
+    
+    // Many paths at once into a contiguous buffer; firstPath numbers the
+    // paths so successive batches continue the same random sequence
+    void generateFBM(PathMatrix& batch, double T, uint64_t firstPath = 0) const {
+        generateFbm(batch, H, T, seed, firstPath);
+    }
+    
+    // Rough Bergomi paths by the hybrid scheme, with xi as the vol-of-vol eta
+    // and v0 as a flat forward variance. Rows of spot (and variance, if given)
+    // are overwritten; firstPath continues the random sequence across batches.
+    void simulateRoughBergomi(PathMatrix& spot, PathMatrix* variance, double T, double S0,
+                              uint64_t firstPath = 0, ThreadPool& pool = defaultThreadPool()) const {
+        RoughBergomiEngine engine({H, xi, rho, v0}, T, spot.steps());
+        engine.simulate(spot, variance, S0, seed, firstPath, pool);
+    }
+    
+    // Stream rough Bergomi paths through a consumer (see path_consumers.h)
+    // without storing them; memory does not grow with paths or steps
+    template <class Consumer>
+    Consumer streamRoughBergomi(size_t paths, size_t steps, double T, double S0, const Consumer& consumer,
+                                ThreadPool& pool = defaultThreadPool()) const {
+        RoughBergomiEngine engine({H, xi, rho, v0}, T, steps);
+        return engine.stream(paths, S0, seed, consumer, pool);
+    }
+    
+    // Fit H, xi (as eta), rho and v0 (as xi0) to a smile surface under the
+    // rough Bergomi dynamics, starting from the current parameters
+    CalibrationResult calibrate(const SmileSurface& surface,
+                                const CalibrationSettings& settings = CalibrationSettings()) {
+        RoughBergomiSurfacePricer pricer(surface, settings);
+        CalibrationResult result = calibrateRoughBergomi(pricer, {H, xi, rho, v0}, settings);
+        H = result.params.H;
+        xi = result.params.eta;
+        rho = result.params.rho;
+        v0 = result.params.xi0;
+        return result;
+    }
+    
+    // Rough Heston simulation
+    std::pair<std::vector<double>, std::vector<double>> simulateRoughHeston(int n, double T, double S0) {
+        std::vector<double> prices(n + 1);
+        std::vector<double> variances(n + 1);
+        
+        prices[0] = S0;
+        variances[0] = v0;
+        
+        auto fbm = generateFBM(n, T);
+        
+        double dt = T / n;
+        
+        for (int i = 1; i <= n; ++i) {
+            double dW1 = rng.normal() * std::sqrt(dt);
+            
+            // Rough variance process
+            double dBH = fbm[i] - fbm[i-1];
+            variances[i] = variances[i-1] + xi * std::sqrt(variances[i-1]) * dBH;
+            variances[i] = std::max(variances[i], 0.001);
+            
+            // Price process
+            prices[i] = prices[i-1] * std::exp(-0.5 * variances[i-1] * dt + 
+                                              std::sqrt(variances[i-1]) * dW1);
+        }
+        
+        return {prices, variances};
+    }
+};
@@ -0,0 +1,438 @@
+// Truncated path signatures via Chen's identity
+// A signature truncated at level m lives in one flat buffer: the scalar 1,
+// then the d level-1 terms, the d^2 level-2 terms, ..., the d^m level-m terms,
+// each level a row-major tensor (word i1 i2 ... ik at index sum i_j d^(k-j)).
+// A path is read once: each increment x is appended as S <- S (x) exp(x),
+// which for level k is the Horner form
+//   S_k += ((((x/k + S_1) (x) x/(k-1) + S_2) (x) x/(k-2) + ...) + S_{k-1}) (x) x,
+// run from level m down so that the lower levels are still the old ones.
+// Every tensor step is a row of d products t[a] * x[b] added to a contiguous
+// row, vectorized over b, so a step costs about d^m (d/(d-1))^2 FMAs.
+// Prepending, S <- exp(x) (x) S, is the mirror-image Horner form
+//   S_k += x (x) (S_{k-1} + x/2 (x) (S_{k-2} + ... + x/(k-1) (x) (S_1 + x/k))),
+// and with exp(x)^-1 = exp(-x) it drops the first increment of a path, which
+// lets a sliding window of a stream be updated at a cost independent of its
+// length.
+// The log-signature is the truncated tensor logarithm of the signature, a Lie
+// element, written in the Lyndon basis: the standard bracketings P_w of the
+// Lyndon words w of length <= m. P_w expands to w plus lexicographically
+// larger words, so its coordinates follow from the Lyndon-word entries of the
+// logarithm by a unit triangular solve whose sparse table is built once per
+// (d, m) and shared.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace signature {
+
+// out[a * d + b] = u[a] * x[b] + add[a * d + b] for a in [0, rows); out may
+// alias u (rows are written from the last one down) and add may alias out
+template <class V>
+inline void rowStep(double ua, const double* x, const double* add, double* out, size_t b) {
+    simd::fma(V(ua), V::load(x + b), V::load(add + b)).store(out + b);
+}
+
+inline void tensorStep(const double* u, size_t rows, const double* x, size_t d, const double* add, double* out) {
+    using V = simd::Native;
+    for (size_t a = rows; a-- > 0;) {
+        const double ua = u[a];
+        const double* addRow = add + a * d;
+        double* outRow = out + a * d;
+        size_t b = 0;
+        for (; b + V::width <= d; b += V::width) rowStep<V>(ua, x, addRow, outRow, b);
+        for (; b < d; ++b) rowStep<simd::Scalar>(ua, x, addRow, outRow, b);
+    }
+}
+
+} // namespace signature
+
+class SignatureEngine {
+private:
+    size_t d, m;
+    std::vector<size_t> offsets;   // start of each level, offsets[m + 1] = size
+
+    struct Scratch {
+        AlignedVector<double> u, v, scaled, increment, series, product;
+    };
+
+    Scratch& scratch() const {
+        thread_local Scratch s;
+        const size_t top = m > 0 ? levelSize(m - 1) : 1;
+        if (s.u.size() < top) s.u.resize(top);
+        if (s.v.size() < top) s.v.resize(top);
+        if (s.scaled.size() < (m + 1) * d) s.scaled.resize((m + 1) * d);
+        if (s.increment.size() < d) s.increment.resize(d);
+        if (s.series.size() < size()) {
+            s.series.resize(size());
+            s.product.resize(size());
+        }
+        return s;
+    }
+
+    void appendWith(Scratch& s, double* sig, const double* x) const {
+        // scaled[c] = x / c
+        for (size_t c = 1; c <= m; ++c) {
+            const double inverse = 1.0 / c;
+            for (size_t b = 0; b < d; ++b) s.scaled[c * d + b] = x[b] * inverse;
+        }
+        for (size_t k = m; k >= 2; --k) {
+            double* u = s.u.data();
+            const double* level1 = sig + offsets[1];
+            for (size_t b = 0; b < d; ++b) u[b] = s.scaled[k * d + b] + level1[b];
+            for (size_t j = 2; j < k; ++j) {
+                signature::tensorStep(u, levelSize(j - 1), &s.scaled[(k - j + 1) * d], d, sig + offsets[j], u);
+            }
+            double* top = sig + offsets[k];
+            signature::tensorStep(u, levelSize(k - 1), x, d, top, top);
+        }
+        if (m >= 1) {
+            for (size_t b = 0; b < d; ++b) sig[offsets[1] + b] += x[b];
+        }
+    }
+
+    void prependWith(Scratch& s, double* sig, const double* x) const {
+        for (size_t c = 1; c <= m; ++c) {
+            const double inverse = 1.0 / c;
+            for (size_t b = 0; b < d; ++b) s.scaled[c * d + b] = x[b] * inverse;
+        }
+        for (size_t k = m; k >= 2; --k) {
+            // Tensor steps read all of their right operand, so the partial
+            // products alternate between two buffers
+            double* in = s.u.data();
+            double* out = s.v.data();
+            const double* level1 = sig + offsets[1];
+            for (size_t b = 0; b < d; ++b) in[b] = s.scaled[k * d + b] + level1[b];
+            for (size_t j = 2; j < k; ++j) {
+                signature::tensorStep(&s.scaled[(k - j + 1) * d], d, in, levelSize(j - 1), sig + offsets[j], out);
+                std::swap(in, out);
+            }
+            double* top = sig + offsets[k];
+            signature::tensorStep(x, d, in, levelSize(k - 1), top, top);
+        }
+        if (m >= 1) {
+            for (size_t b = 0; b < d; ++b) sig[offsets[1] + b] += x[b];
+        }
+    }
+
+    // out_k = sum_{i=1..k} t_i (x) r_{k-i} for k in [1, top] and out_0 = 0,
+    // the product of r with t, whose scalar term is ignored
+    void multiplyTail(const double* t, const double* r, double* out, size_t top) const {
+        out[0] = 0.0;
+        for (size_t k = 1; k <= top; ++k) {
+            // The scalar term of r scales t_k; the rest are tensor steps
+            double* target = out + offsets[k];
+            const double* tk = t + offsets[k];
+            for (size_t j = 0; j < levelSize(k); ++j) target[j] = r[0] * tk[j];
+            for (size_t i = 1; i < k; ++i) {
+                signature::tensorStep(t + offsets[i], levelSize(i), r + offsets[k - i], levelSize(k - i), target,
+                                      target);
+            }
+        }
+    }
+
+public:
+    SignatureEngine(size_t dim, size_t level) : d(dim), m(level) {
+        if (dim == 0) throw std::invalid_argument("SignatureEngine: dimension must be positive");
+        size_t offset = 0, width = 1;
+        for (size_t k = 0; k <= m; ++k) {
+            offsets.push_back(offset);
+            offset += width;
+            width *= d;
+        }
+        offsets.push_back(offset);
+    }
+
+    size_t dimension() const { return d; }
+    size_t level() const { return m; }
+    size_t size() const { return offsets.back(); }
+    size_t levelOffset(size_t k) const { return offsets[k]; }
+    size_t levelSize(size_t k) const { return offsets[k + 1] - offsets[k]; }
+
+    // Signature of the constant path: 1, 0, 0, ...
+    void identity(double* sig) const {
+        std::fill(sig, sig + size(), 0.0);
+        sig[0] = 1.0;
+    }
+
+    // sig <- sig (x) exp(x) for one increment x (d values)
+    void append(double* sig, const double* x) const { appendWith(scratch(), sig, x); }
+
+    // sig <- exp(x) (x) sig; prepending -x removes a leading increment x
+    void prepend(double* sig, const double* x) const { prependWith(scratch(), sig, x); }
+
+    // Signature of a piecewise-linear path of points x dim values (row-major)
+    void compute(const double* path, size_t points, double* sig) const {
+        identity(sig);
+        Scratch& s = scratch();
+        for (size_t i = 1; i < points; ++i) {
+            for (size_t b = 0; b < d; ++b) s.increment[b] = path[i * d + b] - path[(i - 1) * d + b];
+            appendWith(s, sig, s.increment.data());
+        }
+    }
+
+    std::vector<double> compute(const std::vector<double>& path) const {
+        std::vector<double> sig(size());
+        compute(path.data(), path.size() / d, sig.data());
+        return sig;
+    }
+
+    // out = log(sig) for sig with scalar term 1, so out[0] = 0; out must not
+    // alias sig. With T = sig - 1 the series is evaluated as
+    //   log(1 + T) = T (1 - T (1/2 - T (1/3 - ... T (1/m)))),
+    // where the n-th bracket from the outside is only needed up to level m - n.
+    void logarithm(const double* sig, double* out) const {
+        if (m == 0) {
+            out[0] = 0.0;
+            return;
+        }
+        Scratch& s = scratch();
+        double* r = s.series.data();
+        double* next = s.product.data();
+        r[0] = (m % 2 ? 1.0 : -1.0) / m;
+        for (size_t n = m - 1; n >= 1; --n) {
+            multiplyTail(sig, r, next, m - n);
+            next[0] = (n % 2 ? 1.0 : -1.0) / n;
+            std::swap(r, next);
+        }
+        multiplyTail(sig, r, out, m);
+    }
+
+    // out = a (x) b in the truncated tensor algebra for a and b with scalar
+    // term 1; out must not alias them. By Chen's identity the signature of a
+    // concatenation of paths is the product of their signatures.
+    void multiply(const double* a, const double* b, double* out) const {
+        for (size_t k = 0; k <= m; ++k) {
+            double* target = out + offsets[k];
+            std::copy(b + offsets[k], b + offsets[k + 1], target);
+            for (size_t i = 1; i <= k; ++i) {
+                const size_t right = levelSize(k - i);
+                const double* left = a + offsets[i];
+                const double* tail = b + offsets[k - i];
+                for (size_t x = 0; x < levelSize(i); ++x) {
+                    signature::tensorStep(left + x, 1, tail, right, target + x * right, target + x * right);
+                }
+            }
+        }
+    }
+};
+
+// Lyndon words of length <= m over d letters, ordered by length and then
+// lexicographically, with the tables to move a Lie element between tensor
+// coordinates and coordinates in the basis of their standard bracketings
+class LyndonBasis {
+private:
+    SignatureEngine eng;
+    std::vector<std::vector<uint32_t>> letters;
+    std::vector<size_t> position;          // flat tensor index of each word
+    std::vector<size_t> solveStart;        // triangular solve, CSR by basis element:
+    std::vector<uint32_t> solveFrom;       //   coord[j] -= sum coef * coord[from]
+    std::vector<double> solveCoef;
+    std::vector<size_t> expandStart;       // P_w in tensor coordinates, CSR
+    std::vector<size_t> expandIndex;
+    std::vector<double> expandCoef;
+
+    using Polynomial = std::map<size_t, double>;   // level-local word index -> coefficient
+
+    static bool isLyndon(const uint32_t* w, size_t n) {
+        for (size_t s = 1; s < n; ++s) {
+            if (!std::lexicographical_compare(w, w + n, w + s, w + n)) return false;
+        }
+        return true;
+    }
+
+public:
+    LyndonBasis(size_t dim, size_t level) : eng(dim, level) {
+        const size_t d = dim, m = level;
+        // Duval's generation, which visits Lyndon words in lexicographic order
+        std::vector<uint32_t> w;
+        if (m > 0) w.push_back(0);
+        while (!w.empty()) {
+            letters.push_back(w);
+            const size_t n = w.size();
+            while (w.size() < m) w.push_back(w[w.size() - n]);
+            while (!w.empty() && w.back() == d - 1) w.pop_back();
+            if (!w.empty()) ++w.back();
+        }
+        std::stable_sort(letters.begin(), letters.end(),
+                         [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) { return a.size() < b.size(); });
+
+        // P_w = [P_u, P_v] for the split w = uv with v the longest proper
+        // Lyndon suffix; the shorter brackets are already expanded
+        std::map<std::pair<size_t, size_t>, Polynomial> bracket;   // (length, index) -> P_w
+        std::vector<size_t> power(m + 1, 1);
+        for (size_t k = 1; k <= m; ++k) power[k] = power[k - 1] * d;
+        std::vector<size_t> local(letters.size());
+        for (size_t i = 0; i < letters.size(); ++i) {
+            const auto& word = letters[i];
+            const size_t n = word.size();
+            size_t index = 0;
+            for (uint32_t a : word) index = index * d + a;
+            local[i] = index;
+            position.push_back(eng.levelOffset(n) + index);
+
+            Polynomial P;
+            if (n == 1) {
+                P[index] = 1.0;
+            } else {
+                size_t split = 1;
+                while (!isLyndon(word.data() + split, n - split)) ++split;
+                size_t left = 0, right = 0;
+                for (size_t j = 0; j < split; ++j) left = left * d + word[j];
+                for (size_t j = split; j < n; ++j) right = right * d + word[j];
+                const Polynomial& U = bracket.at({split, left});
+                const Polynomial& V = bracket.at({n - split, right});
+                for (const auto& [a, ca] : U) {
+                    for (const auto& [b, cb] : V) {
+                        P[a * power[n - split] + b] += ca * cb;
+                        P[b * power[split] + a] -= ca * cb;
+                    }
+                }
+            }
+            bracket[{n, index}] = P;
+        }
+
+        // Coordinate of word j in P_i is nonzero only for i <= j (same
+        // length), so coordinates come out in order by forward substitution
+        std::map<size_t, size_t> basisOf;   // flat tensor index -> basis element
+        for (size_t i = 0; i < letters.size(); ++i) basisOf[position[i]] = i;
+        std::vector<std::vector<std::pair<uint32_t, double>>> columns(letters.size());
+        for (size_t i = 0; i < letters.size(); ++i) {
+            const size_t n = letters[i].size();
+            expandStart.push_back(expandIndex.size());
+            for (const auto& [word, coef] : bracket.at({n, local[i]})) {
+                if (coef == 0.0) continue;
+                const size_t flat = eng.levelOffset(n) + word;
+                expandIndex.push_back(flat);
+                expandCoef.push_back(coef);
+                auto j = basisOf.find(flat);
+                if (j != basisOf.end() && j->second != i) columns[j->second].push_back({static_cast<uint32_t>(i), coef});
+            }
+        }
+        expandStart.push_back(expandIndex.size());
+        for (const auto& column : columns) {
+            solveStart.push_back(solveFrom.size());
+            for (const auto& [i, coef] : column) {
+                solveFrom.push_back(i);
+                solveCoef.push_back(coef);
+            }
+        }
+        solveStart.push_back(solveFrom.size());
+    }
+
+    // Shared, lazily built basis for (dim, level)
+    static std::shared_ptr<const LyndonBasis> get(size_t dim, size_t level) {
+        static std::mutex mutex;
+        static std::map<std::pair<size_t, size_t>, std::shared_ptr<const LyndonBasis>> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = cache[{dim, level}];
+        if (!entry) entry = std::make_shared<const LyndonBasis>(dim, level);
+        return entry;
+    }
+
+    const SignatureEngine& engine() const { return eng; }
+    size_t size() const { return letters.size(); }
+    const std::vector<uint32_t>& word(size_t i) const { return letters[i]; }
+
+    // Basis coordinates of a Lie element given in tensor coordinates
+    void project(const double* tensor, double* coords) const {
+        for (size_t j = 0; j < size(); ++j) {
+            double c = tensor[position[j]];
+            for (size_t e = solveStart[j]; e < solveStart[j + 1]; ++e) c -= solveCoef[e] * coords[solveFrom[e]];
+            coords[j] = c;
+        }
+    }
+
+    // tensor = sum_i coords[i] P_i, the inverse of project
+    void expand(const double* coords, double* tensor) const {
+        std::fill(tensor, tensor + eng.size(), 0.0);
+        for (size_t i = 0; i < size(); ++i) {
+            for (size_t e = expandStart[i]; e < expandStart[i + 1]; ++e) tensor[expandIndex[e]] += coords[i] * expandCoef[e];
+        }
+    }
+
+    // Log-signature coordinates of a signature
+    void logSignature(const double* sig, double* coords) const {
+        thread_local AlignedVector<double> logarithm;
+        if (logarithm.size() < eng.size()) logarithm.resize(eng.size());
+        eng.logarithm(sig, logarithm.data());
+        project(logarithm.data(), coords);
+    }
+
+    // Log-signature coordinates of a piecewise-linear path of points x dim
+    // values (row-major)
+    void compute(const double* path, size_t points, double* coords) const {
+        thread_local AlignedVector<double> sig;
+        if (sig.size() < eng.size()) sig.resize(eng.size());
+        eng.compute(path, points, sig.data());
+        logSignature(sig.data(), coords);
+    }
+};
+
+// Signature of the last `window` increments of a stream. Each push appends
+// the new increment and, once the window is full, prepends the inverse of
+// the oldest one, so a tick costs two Horner updates whatever the window.
+// Rounding in the add/remove cycle is reset by recomputing the window from
+// its ring buffer every `refresh` pushes (64 windows by default).
+class SlidingSignature {
+private:
+    SignatureEngine eng;
+    size_t capacity, refresh;
+    size_t count = 0, oldest = 0, sinceRebuild = 0;
+    AlignedVector<double> ring;      // capacity x d increments
+    AlignedVector<double> sig;
+    AlignedVector<double> negated;
+
+    void rebuild() {
+        const size_t d = eng.dimension();
+        eng.identity(sig.data());
+        for (size_t i = 0; i < count; ++i) eng.append(sig.data(), &ring[((oldest + i) % capacity) * d]);
+        sinceRebuild = 0;
+    }
+
+public:
+    SlidingSignature(size_t dim, size_t level, size_t window, size_t refreshEvery = 0)
+        : eng(dim, level), capacity(window), refresh(refreshEvery ? refreshEvery : 64 * window),
+          ring(window * dim), sig(eng.size()), negated(dim) {
+        if (window == 0) throw std::invalid_argument("SlidingSignature: window must be positive");
+        eng.identity(sig.data());
+    }
+
+    const SignatureEngine& engine() const { return eng; }
+    size_t window() const { return capacity; }
+    size_t increments() const { return count; }
+    bool full() const { return count == capacity; }
+    const double* signature() const { return sig.data(); }
+
+    void push(const double* x) {
+        const size_t d = eng.dimension();
+        if (count == capacity) {
+            const double* old = &ring[oldest * d];
+            for (size_t b = 0; b < d; ++b) negated[b] = -old[b];
+            eng.prepend(sig.data(), negated.data());
+            std::copy(x, x + d, ring.begin() + oldest * d);
+            oldest = oldest + 1 == capacity ? 0 : oldest + 1;
+        } else {
+            std::copy(x, x + d, ring.begin() + ((oldest + count) % capacity) * d);
+            ++count;
+        }
+        eng.append(sig.data(), x);
+        if (++sinceRebuild >= refresh) rebuild();
+    }
+
+    void reset() {
+        count = oldest = sinceRebuild = 0;
+        eng.identity(sig.data());
+    }
+};
@@ -0,0 +1,232 @@
+// Signature kernels by the Goursat PDE (Salvi et al. 2021)
+// The inner product of the untruncated signatures of two paths,
+// k(x, y) = <S(x), S(y)>, is K(1, 1) for the solution of
+//   d^2 K / ds dt = <x'(s), y'(t)> K,   K(0, .) = K(., 0) = 1.
+// On the grid of the two paths' increments, each split into 2^order equal
+// pieces, the explicit second-order scheme is
+//   K[i+1][j+1] = (K[i+1][j] + K[i][j+1]) (1 + a/2 + a^2/12) - K[i][j] (1 - a^2/12)
+// with a = <dx_i, dy_j>. Cells on one anti-diagonal are independent, so a
+// solve sweeps the anti-diagonals in three rotating buffers indexed by row
+// and vectorizes along each one: with the increments of x stored one
+// dimension per row and those of y in reverse order, every operand of a
+// diagonal is a contiguous run. Gram matrices and library searches spread
+// independent solves over the pool.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Equal-length paths prepared for kernel solves: per path, dim rows of
+// refined increments in time order and the same rows reversed
+class KernelPaths {
+private:
+    size_t count = 0, d = 0, n = 0, order = 0;
+    AlignedVector<double> forwardRows, reversedRows;
+
+public:
+    KernelPaths() = default;
+
+    // paths is count x points x dim, row-major
+    KernelPaths(const double* paths, size_t pathCount, size_t points, size_t dim, size_t dyadicOrder = 0)
+        : count(pathCount), d(dim), order(dyadicOrder) {
+        if (dim == 0 || points < 2) throw std::invalid_argument("KernelPaths: need a dimension and two points");
+        const size_t pieces = size_t(1) << order;
+        const double scale = 1.0 / pieces;
+        n = (points - 1) * pieces;
+        forwardRows.resize(count * d * n);
+        reversedRows.resize(count * d * n);
+        for (size_t p = 0; p < count; ++p) {
+            const double* path = paths + p * points * d;
+            double* forward = &forwardRows[p * d * n];
+            double* reversed = &reversedRows[p * d * n];
+            for (size_t c = 0; c < d; ++c) {
+                for (size_t i = 0; i < n; ++i) {
+                    const size_t step = i >> order;
+                    const double dx = (path[(step + 1) * d + c] - path[step * d + c]) * scale;
+                    forward[c * n + i] = dx;
+                    reversed[c * n + n - 1 - i] = dx;
+                }
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+    size_t dimension() const { return d; }
+    size_t increments() const { return n; }
+    size_t dyadicOrder() const { return order; }
+    const double* forward(size_t p) const { return &forwardRows[p * d * n]; }
+    const double* reversed(size_t p) const { return &reversedRows[p * d * n]; }
+};
+
+namespace signature {
+
+// Cell k of a run of one anti-diagonal; every pointer starts at the run
+template <class V>
+inline void goursatStep(const double* x, size_t n, const double* y, size_t m, size_t dim, const double* left,
+                        const double* corner, double* out, size_t k) {
+    V a(0.0);
+    for (size_t c = 0; c < dim; ++c) a = simd::fma(V::load(x + c * n + k), V::load(y + c * m + k), a);
+    const V square = a * a * V(1.0 / 12.0);
+    const V sides = V::load(left + k) + V::load(left + k - 1);
+    const V grow = simd::fma(a, V(0.5), V(1.0) + square);
+    (sides * grow - V::load(corner + k - 1) * (V(1.0) - square)).store(out + k);
+}
+
+// K(n, m) for x given as dim rows of n increments and y as dim rows of m
+// increments in reverse order; diagonals holds 3 (n + 1) doubles
+inline double goursatSolve(const double* x, size_t n, const double* y, size_t m, size_t dim, double* diagonals) {
+    using V = simd::Native;
+    if (n == 0 || m == 0) return 1.0;
+    double* corner = diagonals;
+    double* left = corner + n + 1;
+    double* out = left + n + 1;
+    std::fill(diagonals, diagonals + 3 * (n + 1), 1.0);
+
+    // Cell (i, j) of diagonal p = i + j reads (i, j - 1) and (i - 1, j) from
+    // diagonal p - 1 at rows i and i - 1, and (i - 1, j - 1) from p - 2.
+    // Boundary cells are never written, so they keep their initial 1.
+    for (size_t p = 2; p <= n + m; ++p) {
+        const size_t lo = p > m ? p - m : 1;
+        const size_t hi = std::min(n, p - 1);
+        const size_t cells = hi + 1 - lo;
+        const double* xs = x + lo - 1;
+        const double* ys = y + (m + lo - p);
+        size_t k = 0;
+        for (; k + V::width <= cells; k += V::width) {
+            goursatStep<V>(xs, n, ys, m, dim, left + lo, corner + lo, out + lo, k);
+        }
+        // Cells only read earlier diagonals, so a last vector overlapping the
+        // previous one recomputes identical values instead of a scalar tail
+        if (k < cells && cells >= V::width) {
+            goursatStep<V>(xs, n, ys, m, dim, left + lo, corner + lo, out + lo, cells - V::width);
+            k = cells;
+        }
+        for (; k < cells; ++k) goursatStep<simd::Scalar>(xs, n, ys, m, dim, left + lo, corner + lo, out + lo, k);
+
+        double* spare = corner;
+        corner = left;
+        left = out;
+        out = spare;
+    }
+    return left[n];
+}
+
+// Throws unless X and Y can be paired; callers check once before spreading
+// solves over the pool
+inline void checkCompatible(const KernelPaths& X, const KernelPaths& Y, const char* caller) {
+    if (X.dimension() != Y.dimension() || X.dyadicOrder() != Y.dyadicOrder()) {
+        throw std::invalid_argument(std::string(caller) + ": path sets differ in dimension or dyadic order");
+    }
+}
+
+// k(X_i, Y_j) for path sets already checked compatible
+inline double kernel(const KernelPaths& X, size_t i, const KernelPaths& Y, size_t j) {
+    thread_local AlignedVector<double> diagonals;
+    if (diagonals.size() < 3 * (X.increments() + 1)) diagonals.resize(3 * (X.increments() + 1));
+    return goursatSolve(X.forward(i), X.increments(), Y.reversed(j), Y.increments(), X.dimension(),
+                        diagonals.data());
+}
+
+} // namespace signature
+
+// k(X_i, Y_j)
+inline double signatureKernel(const KernelPaths& X, size_t i, const KernelPaths& Y, size_t j) {
+    signature::checkCompatible(X, Y, "signatureKernel");
+    return signature::kernel(X, i, Y, j);
+}
+
+// out (X.size() x Y.size(), row-major) = k(X_i, Y_j), one row per task
+inline void signatureGram(const KernelPaths& X, const KernelPaths& Y, double* out,
+                          ThreadPool& pool = defaultThreadPool()) {
+    signature::checkCompatible(X, Y, "signatureGram");
+    pool.parallelFor(X.size(), [&](size_t i) {
+        for (size_t j = 0; j < Y.size(); ++j) out[i * Y.size() + j] = signature::kernel(X, i, Y, j);
+    });
+}
+
+// Symmetric out (X.size() x X.size()) = k(X_i, X_j), solving each pair once
+inline void signatureGram(const KernelPaths& X, double* out, ThreadPool& pool = defaultThreadPool()) {
+    const size_t count = X.size();
+    pool.parallelFor(count, [&](size_t i) {
+        for (size_t j = i; j < count; ++j) out[i * count + j] = signature::kernel(X, i, X, j);
+    });
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < i; ++j) out[i * count + j] = out[j * count + i];
+    }
+}
+
+// Nearest library path in the signature-kernel distance
+//   d(x, y)^2 = k(x, x) - 2 k(x, y) + k(y, y),
+// with the library's own kernels solved once up front
+class SignatureKernelIndex {
+public:
+    struct Match {
+        size_t index;
+        double distance;
+    };
+
+private:
+    KernelPaths library;
+    AlignedVector<double> selfKernel;
+
+    // Closest of library paths [begin, end) to query q, as a squared
+    // distance; queries must already be checked against the library
+    Match scan(const KernelPaths& queries, size_t q, double self, size_t begin, size_t end) const {
+        Match m{begin, std::numeric_limits<double>::infinity()};
+        for (size_t i = begin; i < end; ++i) {
+            const double squared = self - 2.0 * signature::kernel(queries, q, library, i) + selfKernel[i];
+            if (squared < m.distance) m = {i, squared};
+        }
+        return m;
+    }
+
+    static Match root(Match m) { return {m.index, std::sqrt(std::max(0.0, m.distance))}; }
+
+public:
+    explicit SignatureKernelIndex(KernelPaths paths, ThreadPool& pool = defaultThreadPool())
+        : library(std::move(paths)), selfKernel(library.size()) {
+        pool.parallelFor(library.size(), [&](size_t i) { selfKernel[i] = signature::kernel(library, i, library, i); });
+    }
+
+    size_t size() const { return library.size(); }
+
+    // Nearest neighbour of query q, scanning the library in blocks on the
+    // pool; ties go to the lowest index whatever the thread count
+    Match nearest(const KernelPaths& queries, size_t q, ThreadPool& pool = defaultThreadPool()) const {
+        constexpr size_t block = 256;
+        const size_t blocks = (library.size() + block - 1) / block;
+        signature::checkCompatible(queries, library, "SignatureKernelIndex::nearest");
+        const double self = signature::kernel(queries, q, queries, q);
+        std::vector<Match> best(blocks);
+        pool.parallelFor(blocks, [&](size_t b) {
+            best[b] = scan(queries, q, self, b * block, std::min(library.size(), (b + 1) * block));
+        });
+        Match m{0, std::numeric_limits<double>::infinity()};
+        for (const Match& candidate : best) {
+            if (candidate.distance < m.distance) m = candidate;
+        }
+        return root(m);
+    }
+
+    // Nearest neighbours of every query, one query per task
+    std::vector<Match> nearest(const KernelPaths& queries, ThreadPool& pool = defaultThreadPool()) const {
+        signature::checkCompatible(queries, library, "SignatureKernelIndex::nearest");
+        std::vector<Match> matches(queries.size());
+        pool.parallelFor(queries.size(), [&](size_t q) {
+            const double self = signature::kernel(queries, q, queries, q);
+            matches[q] = root(scan(queries, q, self, 0, library.size()));
+        });
+        return matches;
+    }
+};
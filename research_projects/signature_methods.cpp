@@ -6,172 +6,248 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
 
-class PathSignature {
-private:
-    int truncation_level;
-    
-public:
-    PathSignature(int level = 3) : truncation_level(level) {}
-    
-    // Calculate signature of a path up to given level
-    std::vector<double> calculateSignature(const std::vector<std::vector<double>>& path) {
-        std::vector<double> signature;
-        
-        // Level 0: constant term
-        signature.push_back(1.0);
-        
-        // Level 1: linear terms (increments)
-        int dim = path[0].size();
-        std::vector<double> level1(dim, 0.0);
-        
-        for (int i = 1; i < path.size(); ++i) {
-            for (int d = 0; d < dim; ++d) {
-                level1[d] += path[i][d] - path[i-1][d];
+#include "../common/aligned.h"
+#include "../common/random.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+#include "signature.h"
+#include "signature_kernel.h"
+#include "signature_methods.h"
+
+// Ticks per second through the streaming detector, for one instrument and for
+// many instruments whose ticks arrive interleaved
+void benchmarkRegimeStream(size_t ticks = 10000000) {
+    std::cout << "\nStreaming Regime Detection Benchmark (window 20)\n";
+    Philox4x32 rng(20);
+    for (size_t instruments : {1, 1000}) {
+        std::vector<SignatureRegimeStream> streams(instruments);
+        const size_t perInstrument = ticks / instruments;
+        std::vector<double> prices(perInstrument * instruments);
+        std::vector<double> last(instruments, 100.0);
+        for (size_t i = 0; i < perInstrument; ++i) {
+            for (size_t k = 0; k < instruments; ++k) {
+                last[k] *= std::exp(0.001 * rng.normal());
+                prices[i * instruments + k] = last[k];
             }
         }
         
-        for (double val : level1) {
-            signature.push_back(val);
-        }
-        
-        // Level 2: quadratic terms (area-like terms)
-        if (truncation_level >= 2) {
-            for (int d1 = 0; d1 < dim; ++d1) {
-                for (int d2 = 0; d2 < dim; ++d2) {
-                    double area = 0.0;
-                    double sum1 = 0.0;
-                    
-                    for (int i = 1; i < path.size(); ++i) {
-                        double inc1 = path[i][d1] - path[i-1][d1];
-                        double inc2 = path[i][d2] - path[i-1][d2];
-                        
-                        area += sum1 * inc2;
-                        sum1 += inc1;
-                    }
-                    
-                    signature.push_back(area);
-                }
+        size_t changes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < perInstrument; ++i) {
+            for (size_t k = 0; k < instruments; ++k) {
+                streams[k].update(prices[i * instruments + k]);
+                changes += streams[k].regimeChange();
             }
         }
-        
-        return signature;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("  %4zu instrument(s): %6.1f M ticks/s (%.0f ns/tick, %zu flagged)\n", instruments,
+                    prices.size() / seconds / 1e6, 1e9 * seconds / prices.size(), changes);
+    }
+}
+
+// Nightly-scale batch feature build: instruments x 390 bars through the
+// batched API, checked against features assembled per instrument from a
+// point-by-point path as extractFeatures used to
+void benchmarkFeatureBatch(size_t instruments = 20000, size_t bars = 390) {
+    std::cout << "\nBatch Feature Extraction Benchmark (" << instruments << " x " << bars << " bars, "
+              << defaultThreadPool().size() << " threads)\n";
+    Philox4x32 rng(21);
+    std::vector<double> prices(instruments * bars);
+    for (size_t k = 0; k < instruments; ++k) {
+        double* row = &prices[k * bars];
+        row[0] = 100.0;
+        for (size_t i = 1; i < bars; ++i) row[i] = row[i - 1] * std::exp(0.001 * rng.normal());
     }
     
-    // Calculate log signature (more stable for long paths)
-    std::vector<double> calculateLogSignature(const std::vector<std::vector<double>>& path) {
-        auto sig = calculateSignature(path);
-        
-        // Extract log signature components (simplified)
-        std::vector<double> log_sig;
-        
-        // Level 1 terms are the same
-        int dim = path[0].size();
-        for (int i = 1; i <= dim; ++i) {
-            log_sig.push_back(sig[i]);
+    SignatureBasedPredictor predictor(3);
+    const size_t width = predictor.featureCount();
+    std::vector<double> features(instruments * width);
+    auto start = std::chrono::steady_clock::now();
+    predictor.extractFeatures(prices.data(), instruments, bars, features.data());
+    double batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    PathSignature reference(3);
+    const size_t sample = std::min<size_t>(instruments, 2000);
+    double difference = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < sample; ++k) {
+        const double* row = &prices[k * bars];
+        std::vector<std::vector<double>> path;
+        double squares = 0.0;
+        for (size_t i = 1; i < bars; ++i) {
+            double r = std::log(row[i] / row[i - 1]);
+            path.push_back({r, std::abs(r)});
+            squares += r * r;
         }
-        
-        // Level 2: antisymmetric part
-        if (truncation_level >= 2) {
-            int start_idx = 1 + dim;
-            for (int d1 = 0; d1 < dim; ++d1) {
-                for (int d2 = d1 + 1; d2 < dim; ++d2) {
-                    double antisym = sig[start_idx + d1*dim + d2] - sig[start_idx + d2*dim + d1];
-                    log_sig.push_back(antisym);
+        auto expected = reference.calculateLogSignature(path);
+        expected.push_back(std::sqrt(squares / (bars - 1)));
+        expected.push_back(std::log(row[bars - 1] / row[0]));
+        for (size_t j = 0; j < width; ++j) {
+            difference = std::max(difference, std::abs(expected[j] - features[k * width + j]));
+        }
+    }
+    double perSeries = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / sample;
+    
+    std::printf("  batched:        %8.1f ms (%.2f us/instrument)\n", 1e3 * batched, 1e6 * batched / instruments);
+    std::printf("  point-by-point: %8.1f ms projected (%.2f us/instrument), max difference %.1e\n",
+                1e3 * perSeries * instruments, 1e6 * perSeries, difference);
+}
+
+// One-pass signature cost over 390-point intraday paths for d <= 8 and
+// m <= 5, plus Chen's identity as a check: S(whole) = S(first) (x) S(second)
+void benchmarkSignature(size_t points = 390) {
+    std::cout << "\nSignature Engine Benchmark (" << points << "-point paths, " << simd::nativeName() << ")\n";
+    std::cout << "  d  m     terms   us/path  ns/increment  Chen error\n";
+    Philox4x32 rng(19);
+    for (size_t d : {2, 4, 6, 8}) {
+        for (size_t m = 2; m <= 5; ++m) {
+            SignatureEngine engine(d, m);
+            const size_t paths = std::max<size_t>(4, 20000000 / (points * engine.size()));
+            std::vector<double> path(paths * points * d);
+            for (size_t p = 0; p < paths; ++p) {
+                double* row = &path[p * points * d];
+                for (size_t b = 0; b < d; ++b) row[b] = 0.0;
+                for (size_t i = 1; i < points; ++i) {
+                    for (size_t b = 0; b < d; ++b) row[i * d + b] = row[(i - 1) * d + b] + 0.05 * rng.normal();
                 }
             }
+            
+            std::vector<double> sig(engine.size());
+            double checksum = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t p = 0; p < paths; ++p) {
+                engine.compute(&path[p * points * d], points, sig.data());
+                checksum += sig.back();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            // Split the first path at its midpoint (the shared point belongs to both halves)
+            const size_t half = points / 2;
+            std::vector<double> first(engine.size()), second(engine.size()), joined(engine.size());
+            engine.compute(&path[0], half + 1, first.data());
+            engine.compute(&path[half * d], points - half, second.data());
+            engine.multiply(first.data(), second.data(), joined.data());
+            engine.compute(&path[0], points, sig.data());
+            double error = 0.0;
+            for (size_t i = 0; i < sig.size(); ++i) error = std::max(error, std::abs(sig[i] - joined[i]));
+            
+            std::printf("%3zu %2zu %9zu %9.1f %13.1f %11.1e%s\n", d, m, engine.size(), 1e6 * seconds / paths,
+                        1e9 * seconds / (paths * (points - 1)), error, std::isfinite(checksum) ? "" : " (non-finite)");
         }
-        
-        return log_sig;
     }
-};
+}
 
-class SignatureBasedPredictor {
-private:
-    PathSignature signature_calc;
-    std::vector<std::vector<double>> feature_weights;
-    
-public:
-    SignatureBasedPredictor(int sig_level = 3) : signature_calc(sig_level) {
-        // Initialize simple linear model weights
-        feature_weights.resize(1);
+// Log-signature size against the signature, the one-off cost of the Lyndon
+// tables, and the per-path cost of logarithm plus projection
+void benchmarkLogSignature() {
+    std::cout << "\nLog-Signature Benchmark (Lyndon basis)\n";
+    std::cout << "  d  m  sig terms  logsig terms  tables ms  us/path (log + projection)\n";
+    Philox4x32 rng(22);
+    for (size_t d : {2, 4, 6, 8}) {
+        for (size_t m = 2; m <= 5; ++m) {
+            auto start = std::chrono::steady_clock::now();
+            auto basis = LyndonBasis::get(d, m);
+            double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            const SignatureEngine& engine = basis->engine();
+            const size_t points = 50;
+            std::vector<double> path(points * d, 0.0), sig(engine.size()), coords(basis->size());
+            for (size_t i = 1; i < points; ++i) {
+                for (size_t b = 0; b < d; ++b) path[i * d + b] = path[(i - 1) * d + b] + 0.05 * rng.normal();
+            }
+            engine.compute(path.data(), points, sig.data());
+            
+            const size_t repeats = std::max<size_t>(4, 20000000 / (m * engine.size()));
+            double checksum = 0.0;
+            start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; ++r) {
+                basis->logSignature(sig.data(), coords.data());
+                checksum += coords.back();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::printf("%3zu %2zu %10zu %13zu %10.2f %12.2f%s\n", d, m, engine.size(), basis->size(), 1e3 * build,
+                        1e6 * seconds / repeats, std::isfinite(checksum) ? "" : " (non-finite)");
+        }
     }
+}
+
+// Signature-kernel Gram matrices at nightly scale, and nearest-neighbour
+// regime lookup of live windows against a library of labelled windows
+void benchmarkSignatureKernel(size_t paths = 1000, size_t steps = 100, size_t libraryWindows = 10000) {
+    ThreadPool& pool = defaultThreadPool();
+    std::cout << "\nSignature Kernel Benchmark (" << simd::nativeName() << ", " << pool.size() << " threads)\n";
+    Philox4x32 rng(23);
     
-    // Extract features from price path using signatures
-    std::vector<double> extractFeatures(const std::vector<double>& prices) {
-        // Convert price path to log-return path
-        std::vector<std::vector<double>> path;
-        
-        for (int i = 1; i < prices.size(); ++i) {
-            double log_return = std::log(prices[i] / prices[i-1]);
-            double abs_return = std::abs(log_return);
-            path.push_back({log_return, abs_return});
+    // Brownian paths in two dimensions over [0, 1]
+    const size_t dim = 2;
+    std::vector<double> walks(2 * paths * (steps + 1) * dim, 0.0);
+    for (size_t p = 0; p < 2 * paths; ++p) {
+        double* row = &walks[p * (steps + 1) * dim];
+        for (size_t i = 1; i <= steps; ++i) {
+            for (size_t c = 0; c < dim; ++c) row[i * dim + c] = row[(i - 1) * dim + c] + rng.normal() / std::sqrt(double(steps));
         }
-        
-        // Calculate signature features
-        auto sig_features = signature_calc.calculateLogSignature(path);
-        
-        // Add traditional features
-        std::vector<double> features = sig_features;
-        
-        // Realized volatility
-        double realized_vol = 0.0;
-        for (int i = 1; i < prices.size(); ++i) {
-            double ret = std::log(prices[i] / prices[i-1]);
-            realized_vol += ret * ret;
-        }
-        realized_vol = std::sqrt(realized_vol / (prices.size() - 1));
-        features.push_back(realized_vol);
-        
-        // Price momentum
-        double momentum = std::log(prices.back() / prices[0]);
-        features.push_back(momentum);
-        
-        return features;
     }
+    KernelPaths X(walks.data(), paths, steps + 1, dim);
+    KernelPaths Y(&walks[paths * (steps + 1) * dim], paths, steps + 1, dim);
+    std::vector<double> gram(paths * paths);
     
-    // Predict next period volatility
-    double predictVolatility(const std::vector<double>& prices) {
-        auto features = extractFeatures(prices);
-        
-        // Simple linear prediction (in practice, use more sophisticated ML)
-        double prediction = 0.2; // Base volatility
-        
-        if (features.size() >= 2) {
-            // Use signature features for prediction
-            prediction += 0.1 * features[0]; // Log return signature
-            prediction += 0.05 * features[features.size()-1]; // Realized vol
-            prediction = std::max(0.01, std::min(1.0, prediction)); // Bound prediction
-        }
-        
-        return prediction;
+    auto start = std::chrono::steady_clock::now();
+    signatureGram(X, gram.data(), pool);
+    double symmetric = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    signatureGram(X, Y, gram.data(), pool);
+    double cross = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double cells = double(paths) * paths * steps * steps;
+    std::printf("  %zu x %zu Gram, %zu steps: symmetric %.2f s, cross %.2f s (%.2f G cells/s)\n", paths, paths,
+                steps, symmetric, cross, cells / cross / 1e9);
+    
+    // Dyadic refinement converges on the untruncated kernel
+    std::cout << "  k(X_0, Y_0) by dyadic order:";
+    for (size_t order = 0; order <= 3; ++order) {
+        KernelPaths x(walks.data(), 1, steps + 1, dim, order);
+        KernelPaths y(&walks[paths * (steps + 1) * dim], 1, steps + 1, dim, order);
+        std::printf(" %.6f", signatureKernel(x, 0, y, 0));
     }
+    std::cout << "\n";
     
-    // Detect regime changes using signature analysis
-    bool detectRegimeChange(const std::vector<double>& prices, int window = 20) {
-        if (prices.size() < 2 * window) return false;
-        
-        // Compare signatures of recent vs historical windows
-        std::vector<double> recent(prices.end() - window, prices.end());
-        std::vector<double> historical(prices.end() - 2*window, prices.end() - window);
-        
-        auto sig_recent = extractFeatures(recent);
-        auto sig_historical = extractFeatures(historical);
-        
-        // Calculate signature distance
-        double distance = 0.0;
-        int min_size = std::min(sig_recent.size(), sig_historical.size());
-        
-        for (int i = 0; i < min_size; ++i) {
-            distance += (sig_recent[i] - sig_historical[i]) * (sig_recent[i] - sig_historical[i]);
+    // Library of windows from a series that switches between a calm and a
+    // stressed regime every 500 days, labelled by regime; queries come from
+    // a fresh series and are classified by their nearest library window
+    const size_t window = 20;
+    const size_t points = 2 * window - 1;
+    const double vols[2] = {0.01, 0.03};
+    auto sample = [&](size_t windows, std::vector<double>& leadLag, std::vector<int>& regime) {
+        std::vector<double> prices(window);
+        leadLag.assign(windows * points * 2, 0.0);
+        regime.resize(windows);
+        for (size_t w = 0; w < windows; ++w) {
+            regime[w] = (w / 25) % 2;
+            prices[0] = 100.0;
+            for (size_t k = 1; k < window; ++k) prices[k] = prices[k - 1] * std::exp(vols[regime[w]] * rng.normal());
+            leadLagPath(prices.data(), window, 0.01 * std::sqrt(double(window)), &leadLag[w * points * 2]);
         }
-        
-        distance = std::sqrt(distance);
-        
-        // Threshold for regime change detection
-        return distance > 0.5;
-    }
-};
+    };
+    std::vector<double> libraryPaths, queryPaths;
+    std::vector<int> libraryRegime, queryRegime;
+    sample(libraryWindows, libraryPaths, libraryRegime);
+    sample(200, queryPaths, queryRegime);
+    
+    start = std::chrono::steady_clock::now();
+    SignatureKernelIndex index(KernelPaths(libraryPaths.data(), libraryWindows, points, 2), pool);
+    double build = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    KernelPaths queries(queryPaths.data(), queryRegime.size(), points, 2);
+    start = std::chrono::steady_clock::now();
+    auto matches = index.nearest(queries, pool);
+    double lookup = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t correct = 0;
+    for (size_t q = 0; q < matches.size(); ++q) correct += libraryRegime[matches[q].index] == queryRegime[q];
+    std::printf("  regime lookup against %zu windows: index %.1f ms, %.2f ms/query, %zu/%zu regimes recovered\n",
+                index.size(), 1e3 * build, 1e3 * lookup / matches.size(), correct, matches.size());
+}
 
 int main() {
     std::cout << "Path Signature Methods for Finance\n";
@@ -179,25 +255,32 @@ int main() {
     
     // Generate sample price path
     std::vector<double> prices = {100.0};
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<> normal(0.0, 0.02);
+    Philox4x32 rng(2020);
     
     // Simulate price path with regime change
     for (int i = 1; i <= 100; ++i) {
         double vol = (i < 50) ? 0.15 : 0.25; // Regime change at i=50
-        double return_rate = normal(gen) * vol;
+        double return_rate = 0.02 * rng.normal() * vol;
         prices.push_back(prices.back() * std::exp(return_rate));
     }
     
     SignatureBasedPredictor predictor(3);
     
+    // Regime distance for every price, streamed once instead of recomputed
+    // on each prefix
+    SignatureRegimeStream stream(20);
+    std::vector<bool> regime(prices.size());
+    for (size_t i = 0; i < prices.size(); ++i) {
+        stream.update(prices[i]);
+        regime[i] = stream.regimeChange();
+    }
+    
     // Test volatility prediction
     std::cout << "Volatility Predictions:\n";
-    for (int i = 30; i < prices.size(); i += 10) {
+    for (size_t i = 30; i < prices.size(); i += 10) {
         std::vector<double> window(prices.begin() + i - 20, prices.begin() + i);
         double pred_vol = predictor.predictVolatility(window);
-        bool regime_change = predictor.detectRegimeChange(std::vector<double>(prices.begin(), prices.begin() + i));
+        bool regime_change = regime[i - 1];
         
         std::cout << "Day " << i << ": Predicted Vol = " << pred_vol 
                   << ", Regime Change = " << (regime_change ? "Yes" : "No") << std::endl;
@@ -214,5 +297,21 @@ int main() {
     }
     std::cout << std::endl;
     
+    auto basis = LyndonBasis::get(2, 3);
+    auto log_signature = PathSignature(3).calculateLogSignature(sample_path);
+    std::cout << "Sample Path Log Signature (Lyndon basis): ";
+    for (size_t i = 0; i < basis->size(); ++i) {
+        std::cout << "[";
+        for (uint32_t letter : basis->word(i)) std::cout << letter + 1;
+        std::cout << "] " << log_signature[i] << " ";
+    }
+    std::cout << std::endl;
+    
+    benchmarkSignature();
+    benchmarkLogSignature();
+    benchmarkRegimeStream();
+    benchmarkFeatureBatch();
+    benchmarkSignatureKernel();
+    
     return 0;
 }
\ No newline at end of file
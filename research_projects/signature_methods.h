@@ -0,0 +1,279 @@
+// Path signature features for financial time series (Lyons et al. 2020)
+// PathSignature wraps SignatureEngine and LyndonBasis for vector-of-points
+// paths, SignatureBasedPredictor builds log-signature features for many
+// instruments at once, and SignatureRegimeStream tracks the distance between
+// sliding-window signatures of recent and lagged returns tick by tick.
+
+#pragma once
+
+#include "../common/aligned.h"
+#include "../common/simd.h"
+#include "../common/thread_pool.h"
+#include "signature.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+class PathSignature {
+private:
+    int truncation_level;
+    
+public:
+    PathSignature(int level = 3) : truncation_level(level) {}
+    
+    // Signature of a path up to the truncation level: 1, then each level's
+    // row-major tensor, computed in one pass with Chen's identity
+    std::vector<double> calculateSignature(const std::vector<std::vector<double>>& path) {
+        const size_t dim = path[0].size();
+        std::vector<double> flat;
+        flat.reserve(path.size() * dim);
+        for (const auto& point : path) flat.insert(flat.end(), point.begin(), point.end());
+        return SignatureEngine(dim, truncation_level).compute(flat);
+    }
+    
+    // Log signature in the Lyndon basis (more compact than the signature,
+    // and more stable for long paths)
+    std::vector<double> calculateLogSignature(const std::vector<std::vector<double>>& path) {
+        const size_t dim = path[0].size();
+        std::vector<double> flat;
+        flat.reserve(path.size() * dim);
+        for (const auto& point : path) flat.insert(flat.end(), point.begin(), point.end());
+        auto basis = LyndonBasis::get(dim, truncation_level);
+        std::vector<double> log_sig(basis->size());
+        basis->compute(flat.data(), path.size(), log_sig.data());
+        return log_sig;
+    }
+    
+    int level() const { return truncation_level; }
+};
+
+class SignatureBasedPredictor {
+private:
+    std::shared_ptr<const LyndonBasis> basis;   // (log return, |log return|) paths
+    std::vector<std::vector<double>> feature_weights;
+    
+    struct Scratch {
+        AlignedVector<double> returns, path;
+    };
+    
+    // Signature features of one price series into out (featureCount values):
+    // the log signature of the (log return, |log return|) path, then realized
+    // volatility and momentum. Log returns are computed once, vectorized,
+    // into the caller's scratch.
+    void seriesFeatures(const double* prices, size_t bars, Scratch& s, double* out) const {
+        using V = simd::Native;
+        const size_t n = bars - 1;
+        if (s.returns.size() < n) {
+            s.returns.resize(n);
+            s.path.resize(2 * n);
+        }
+        
+        double* r = s.returns.data();
+        size_t i = 0;
+        for (; i + V::width <= n; i += V::width) {
+            simd::log(V::load(prices + i + 1) / V::load(prices + i)).store(r + i);
+        }
+        for (; i < n; ++i) r[i] = std::log(prices[i + 1] / prices[i]);
+        
+        double squares = 0.0;
+        for (i = 0; i < n; ++i) {
+            s.path[2 * i] = r[i];
+            s.path[2 * i + 1] = std::abs(r[i]);
+            squares += r[i] * r[i];
+        }
+        basis->compute(s.path.data(), n, out);
+        
+        out += basis->size();
+        out[0] = std::sqrt(squares / n);                   // realized volatility
+        out[1] = std::log(prices[n] / prices[0]);          // price momentum
+    }
+    
+public:
+    SignatureBasedPredictor(int sig_level = 3) : basis(LyndonBasis::get(2, sig_level)) {
+        // Initialize simple linear model weights
+        feature_weights.resize(1);
+    }
+    
+    size_t featureCount() const { return basis->size() + 2; }
+    
+    // Extract features from price path using signatures
+    std::vector<double> extractFeatures(const std::vector<double>& prices) {
+        std::vector<double> features(featureCount());
+        extractFeatures(prices.data(), 1, prices.size(), features.data());
+        return features;
+    }
+    
+    // Features for many series at once: prices is instruments x bars
+    // (row-major, one instrument per row), features is instruments x
+    // featureCount(). Instruments go to the pool in small blocks taken from a
+    // shared counter, so threads that finish early keep pulling work; each
+    // thread reuses one scratch arena across all of its instruments.
+    void extractFeatures(const double* prices, size_t instruments, size_t bars, double* features,
+                         ThreadPool& pool = defaultThreadPool()) const {
+        if (bars < 2) throw std::invalid_argument("extractFeatures: need at least two prices per instrument");
+        const size_t width = featureCount();
+        constexpr size_t block = 16;
+        const size_t blocks = (instruments + block - 1) / block;
+        pool.parallelFor(blocks, [&](size_t b) {
+            thread_local Scratch scratch;
+            const size_t end = std::min(instruments, (b + 1) * block);
+            for (size_t k = b * block; k < end; ++k) {
+                seriesFeatures(prices + k * bars, bars, scratch, features + k * width);
+            }
+        });
+    }
+    
+    // Predict next period volatility
+    double predictVolatility(const std::vector<double>& prices) {
+        auto features = extractFeatures(prices);
+        
+        // Simple linear prediction (in practice, use more sophisticated ML)
+        double prediction = 0.2; // Base volatility
+        
+        if (features.size() >= 2) {
+            // Use signature features for prediction
+            prediction += 0.1 * features[0]; // Log return signature
+            prediction += 0.05 * features[features.size()-1]; // Realized vol
+            prediction = std::max(0.01, std::min(1.0, prediction)); // Bound prediction
+        }
+        
+        return prediction;
+    }
+    
+    // Detect regime changes using signature analysis
+    bool detectRegimeChange(const std::vector<double>& prices, int window = 20) {
+        if (prices.size() < 2 * static_cast<size_t>(window)) return false;
+        
+        // Compare signatures of recent vs historical windows
+        std::vector<double> recent(prices.end() - window, prices.end());
+        std::vector<double> historical(prices.end() - 2*window, prices.end() - window);
+        
+        auto sig_recent = extractFeatures(recent);
+        auto sig_historical = extractFeatures(historical);
+        
+        // Calculate signature distance
+        double distance = 0.0;
+        int min_size = std::min(sig_recent.size(), sig_historical.size());
+        
+        for (int i = 0; i < min_size; ++i) {
+            distance += (sig_recent[i] - sig_historical[i]) * (sig_recent[i] - sig_historical[i]);
+        }
+        
+        distance = std::sqrt(distance);
+        
+        // Threshold for regime change detection
+        return distance > 0.5;
+    }
+};
+
+// Streaming form of detectRegimeChange for a live tick feed. The features of
+// the recent window come from a sliding signature of the (return, |return|)
+// path plus running sums of returns and squared returns; the historical
+// window is the recent one lagged by `window` prices, so its features are read
+// back from a ring instead of being recomputed. Each tick costs one log, one
+// append, one prepend and one log-signature projection, and publishes the same
+// distance as the batch method.
+class SignatureRegimeStream {
+private:
+    size_t window;
+    double threshold;
+    std::shared_ptr<const LyndonBasis> basis;
+    size_t featureCount;                        // log signature, realized vol, momentum
+    SlidingSignature path;                      // W - 2 increments of W - 1 returns
+    std::vector<double> returns;                // last W - 1 returns, ring
+    std::vector<double> history;                // last W feature vectors, ring
+    std::vector<double> increment, features;
+    size_t ticks = 0;
+    double lastPrice = 0.0, lastPoint[2] = {0.0, 0.0};
+    double sumReturns = 0.0, sumSquares = 0.0;
+    double lastDistance = 0.0;
+
+    // Runs from the first initializer, before any buffer is sized from window
+    static size_t checkedWindow(size_t window) {
+        if (window < 3) throw std::invalid_argument("SignatureRegimeStream: window must be at least 3");
+        return window;
+    }
+
+public:
+    SignatureRegimeStream(size_t window = 20, double threshold = 0.5, int level = 3)
+        : window(checkedWindow(window)), threshold(threshold), basis(LyndonBasis::get(2, level)),
+          featureCount(basis->size() + 2), path(2, level, window - 2), returns(window - 1),
+          history(window * featureCount), increment(2), features(featureCount) {}
+
+    // Feed one price; returns the distance between the signature features of
+    // the last `window` prices and the `window` before them (0 until 2 windows
+    // have been seen)
+    double update(double price) {
+        const size_t t = ticks++;
+        if (t == 0) {
+            lastPrice = price;
+            return lastDistance;
+        }
+        const double r = std::log(price / lastPrice);
+        lastPrice = price;
+        
+        // Running sums over the last W - 1 returns, recomputed whenever the
+        // ring wraps so that rounding does not accumulate
+        const size_t slot = (t - 1) % returns.size();
+        if (t > returns.size()) {
+            const double old = returns[slot];
+            sumReturns -= old;
+            sumSquares -= old * old;
+        }
+        returns[slot] = r;
+        sumReturns += r;
+        sumSquares += r * r;
+        if (slot + 1 == returns.size()) {
+            sumReturns = sumSquares = 0.0;
+            for (double x : returns) {
+                sumReturns += x;
+                sumSquares += x * x;
+            }
+        }
+        
+        const double point[2] = {r, std::abs(r)};
+        if (t > 1) {
+            increment[0] = point[0] - lastPoint[0];
+            increment[1] = point[1] - lastPoint[1];
+            path.push(increment.data());
+        }
+        lastPoint[0] = point[0];
+        lastPoint[1] = point[1];
+        if (t + 1 < window) return lastDistance;
+        
+        // Features of the window ending at this price, as in extractFeatures
+        basis->logSignature(path.signature(), features.data());
+        features[featureCount - 2] = std::sqrt(std::max(0.0, sumSquares) / (window - 1));
+        features[featureCount - 1] = sumReturns;
+        double* lagged = &history[(t % window) * featureCount];
+        if (t + 1 >= 2 * window) {
+            double distance = 0.0;
+            for (size_t i = 0; i < featureCount; ++i) distance += (features[i] - lagged[i]) * (features[i] - lagged[i]);
+            lastDistance = std::sqrt(distance);
+        }
+        std::copy(features.begin(), features.end(), lagged);
+        return lastDistance;
+    }
+    
+    double distance() const { return lastDistance; }
+    bool regimeChange() const { return lastDistance > threshold; }
+};
+
+// Lead-lag path of log prices over one window, (X_0, X_0), (X_1, X_0),
+// (X_1, X_1), ..., with X_k = log(p_k / p_0) / scale: its Levy area is half
+// the realized variance, which is what tells volatility regimes apart
+inline void leadLagPath(const double* prices, size_t count, double scale, double* out) {
+    double lag = 0.0;
+    out[0] = out[1] = 0.0;
+    for (size_t k = 1; k < count; ++k) {
+        const double lead = std::log(prices[k] / prices[0]) / scale;
+        out[4 * k - 2] = lead;
+        out[4 * k - 1] = lag;
+        out[4 * k] = lead;
+        out[4 * k + 1] = lead;
+        lag = lead;
+    }
+}